@@ -26,8 +26,13 @@ to_copy = [
   "scripts/wipe-source.sh",
   "src/CaloStatusMapper.cc",
   "src/CaloStatusMapper.h",
+  "src/CaloStatusMapperColumns.cc",
+  "src/CaloStatusMapperColumns.h",
   "src/CaloStatusMapperDefs.h",
   "src/CaloStatusMapperLinkDef.h",
+  "src/CaloStatusMapperShm.cc",
+  "src/CaloStatusMapperShm.h",
+  "src/CaloStatusMapperShmDump.cc",
   "src/autogen.sh",
   "src/configure.ac",
   "src/Makefile.am",
@@ -12,6 +12,8 @@
 
 // module definition
 #include "CaloStatusMapper.h"
+#include "CaloStatusMapperColumns.h"
+#include "CaloStatusMapperShm.h"
 
 // calo base
 #include <calobase/TowerInfov2.h>
@@ -19,6 +21,12 @@
 // calo trigger
 #include <calotrigger/TriggerAnalyzer.h>
 
+// cdb objects
+#include <cdbobjects/CDBTTree.h>
+
+// ffa objects
+#include <ffaobjects/EventHeader.h>
+
 // f4a libraries
 #include <fun4all/Fun4AllReturnCodes.h>
 #include <fun4all/Fun4AllHistoManager.h>
@@ -27,18 +35,29 @@
 #include <phool/getClass.h>
 #include <phool/phool.h>
 #include <phool/PHCompositeNode.h>
+#include <phool/recoConsts.h>
 
 // qa utilities
 #include <qautils/QAHistManagerDef.h>
 
 // root libraries
+#include <TDirectory.h>
+#include <TFile.h>
 #include <TH1.h>
 #include <TH2.h>
 
 // c++ utiilites
 #include <algorithm>
+#include <array>
 #include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <set>
+#include <sstream>
 
 // abbreviate namespace for convenience
 namespace CSMD = CaloStatusMapperDefs;
@@ -97,6 +116,8 @@ CaloStatusMapper::~CaloStatusMapper()
     std::cout << "CaloStatusMapper::~CaloStatusMapper() Calling dtor" << std::endl;
   }
   delete m_analyzer;
+  delete m_publisher;
+  CloseColumnWriters();
 
 }  // end dtor
 
@@ -123,14 +144,77 @@ int CaloStatusMapper::Init(PHCompositeNode* /*topNode*/)
   InitHistManager();
   BuildHistograms();
 
-  // make sure event no. is set to 0
-  m_nEvent = 0;
+  // make sure event no. is set to 0 and
+  // sampling starts from configured fraction
+  ResetCounters();
+
+  // if needed, restore state from last checkpoint
+  if (m_config.doResume && ReadCheckpoint())
+  {
+    m_nToSkip        = m_nSeen;
+    m_nCheckpoint    = m_nSeen;
+    m_doVerifyResume = true;
+  }
+
+  // if needed, open column files
+  //   - n.b. when resuming, these pick up where
+  //     the checkpoint left off
+  if (m_config.doColumnExport)
+  {
+    OpenColumnWriters();
+  }
+
+  // if needed, open shared-memory segment
+  if (m_config.doShmExport)
+  {
+    OpenPublisher();
+  }
   return Fun4AllReturnCodes::EVENT_OK;
 
 }  // end 'Init(PHCompositeNode*)'
 
 
 
+// ----------------------------------------------------------------------------
+//! Prepare for a new run
+// ----------------------------------------------------------------------------
+/*! If per-run output is turned on, the histograms built in Init are
+ *  reset and reused for each run rather than being reallocated. Any
+ *  reference status maps are (re)loaded here as well.
+ *
+ *  When resuming, counts aren't reset until the events covered
+ *  by the checkpoint have been skipped.
+ */
+int CaloStatusMapper::InitRun(PHCompositeNode* topNode)
+{
+
+  if (m_config.debug)
+  {
+    std::cout << "CaloStatusMapper::InitRun(PHCompositeNode*) Starting new run" << std::endl;
+  }
+
+  // grab run no. in case event header is missing
+  m_runNumber = recoConsts::instance() -> get_IntFlag("RUNNUMBER");
+
+  // if needed, clear previous run's counts
+  if (m_config.doPerRunOutput && (m_nToSkip == 0))
+  {
+    ResetHistograms();
+    m_nEvent = 0;
+  }
+
+  // if needed, load reference maps
+  if (!m_config.refStatusFiles.empty())
+  {
+    GrabNodes(topNode);
+    LoadReferences();
+  }
+  return Fun4AllReturnCodes::EVENT_OK;
+
+}  // end 'InitRun(PHCompositeNode*)'
+
+
+
 // ----------------------------------------------------------------------------
 //! Grab inputs and fills histograms
 // ----------------------------------------------------------------------------
@@ -142,6 +226,58 @@ int CaloStatusMapper::process_event(PHCompositeNode* topNode)
     std::cout << "CaloStatusMapper::process_event(PHCompositeNode* topNode) Processing Event" << std::endl;
   }
 
+  // grab event header for run and event no.s, if available
+  EventHeader* header = findNode::getClass<EventHeader>(topNode, "EventHeader");
+
+  // if resuming, skip events already covered by checkpoint
+  //   - n.b. if those were already skipped upstream (cf.
+  //     GetNEventsToSkip), the first event seen is the
+  //     one the checkpoint left off at
+  if (m_doVerifyResume)
+  {
+    const bool isResumeEvent = m_hasResumeKey
+                            && header
+                            && ((uint64_t) header -> get_RunNumber() == m_resumeRun)
+                            && ((uint64_t) header -> get_EvtSequence() == m_resumeEvent);
+    if ((m_nToSkip > 0) && !isResumeEvent)
+    {
+      --m_nToSkip;
+      return Fun4AllReturnCodes::EVENT_OK;
+    }
+    m_nToSkip        = 0;
+    m_doVerifyResume = false;
+
+    // if this isn't the event checkpoint left off at, the
+    // input differs, so drop restored state
+    if (m_hasResumeKey && !isResumeEvent)
+    {
+      std::cerr << PHWHERE << ": WARNING! Expected to resume at run " << m_resumeRun << ", event " << m_resumeEvent
+                << ", but input doesn't match checkpoint! Starting over from this event." << std::endl;
+      ResetHistograms();
+      ResetCounters();
+      if (m_config.doColumnExport)
+      {
+        OpenColumnWriters();
+      }
+    }
+  }
+
+  // if needed, checkpoint state before counting this event
+  //   - n.b. a failed checkpoint is retried at the next
+  //     interval rather than every event
+  if (!m_config.checkpointFile.empty() && (m_nSeen >= (m_nCheckpoint + std::max<uint64_t>(m_config.checkpointEvents, 1))))
+  {
+    const bool isWritten = WriteCheckpoint(header);
+    if (!isWritten && !m_warnedCheckpoint)
+    {
+      std::cerr << PHWHERE << ": WARNING! Couldn't write checkpoint file " << m_config.checkpointFile
+                << "! Will keep retrying every " << m_config.checkpointEvents << " events without further warnings." << std::endl;
+    }
+    m_warnedCheckpoint = !isWritten;
+    m_nCheckpoint      = m_nSeen;
+  }
+  ++m_nSeen;
+
   // if needed, check if selected trigger fired
   if (m_config.doTrgSelect)
   {
@@ -153,9 +289,55 @@ int CaloStatusMapper::process_event(PHCompositeNode* topNode)
     }
   }
 
+  // start timing if sampling
+  const auto start = std::chrono::steady_clock::now();
+
+  // if sampling events, check if this one should be processed
+  //   - n.b. skipped events still count toward normalization
+  const bool doBlocks = m_config.doSampling && (m_config.sampleMode == CSMD::Sample::Blocks);
+  const bool doEvents = m_config.doSampling && (m_config.sampleMode == CSMD::Sample::Events);
+  if (m_config.doSampling)
+  {
+    m_hists["SampleFraction"] -> Fill(m_sampleFraction);
+  }
+  if (doEvents && !CSMD::IsSampled(m_nEvent, m_sampleFraction))
+  {
+    ++m_nEvent;
+    if (m_publisher && ((m_nEvent % std::max<uint64_t>(m_config.shmUpdateEvents, 1)) == 0))
+    {
+      PublishMaps();
+    }
+    UpdateSampling(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    return Fun4AllReturnCodes::EVENT_OK;
+  }
+  const double weight = m_config.doSampling ? 1. / m_sampleFraction : 1.;
+
   // grab input nodes
   GrabNodes(topNode);
 
+  // if exporting status codes, grab run and event no.
+  //   - n.b. falls back to run no. from InitRun and
+  //     processed-event count if header is missing
+  uint64_t run   = m_runNumber;
+  uint64_t event = m_nEvent;
+  if (m_config.doColumnExport)
+  {
+    if (header)
+    {
+      run   = header -> get_RunNumber();
+      event = header -> get_EvtSequence();
+    }
+    else if (!m_warnedNoHeader)
+    {
+      std::cerr << PHWHERE << ": WARNING! No EventHeader found, exported records will use the no. of processed events as event no.!" << std::endl;
+      m_warnedNoHeader = true;
+    }
+  }
+
+  // instantiate histogram definitions
+  const CSMD::EMCalHistDef emHistDef;
+  const CSMD::HCalHistDef  hcHistDef;
+
   // loop over input nodes
   for (size_t iNode = 0; iNode < m_inNodes.size(); ++iNode)
   {
@@ -164,51 +346,189 @@ int CaloStatusMapper::process_event(PHCompositeNode* topNode)
     const std::string nodeName = m_config.inNodeNames[iNode].first;
     const std::string statBase = MakeBaseName("Status", nodeName);
 
-    // loop over towers
+    // if comparing to a reference, clear observed status bits
+    auto obsPlanes = m_obsPlanes.find(nodeName);
+    const bool doCompare = (obsPlanes != m_obsPlanes.end());
+    if (doCompare)
+    {
+      for (auto& plane : obsPlanes -> second)
+      {
+        plane.Clear();
+      }
+    }
+
+    // if exporting status codes, start a new record
     TowerInfoContainer* towers = m_inNodes[iNode];
-    for (size_t iTower = 0; iTower < towers->size(); ++iTower)
+    CaloStatusMapperColumnWriter* writer = m_config.doColumnExport ? m_colWriters[iNode] : nullptr;
+    if (writer && (towers -> size() > writer -> GetNChannels()))
+    {
+      std::cerr << PHWHERE << ": WARNING! Node " << nodeName << " has " << towers -> size()
+                << " towers but its column file only holds " << writer -> GetNChannels()
+                << " channels, no more status codes will be exported for it!" << std::endl;
+      delete writer;
+      writer = nullptr;
+      m_colWriters[iNode] = nullptr;
+    }
+    uint8_t* record = writer ? writer -> NextRecord(run, event) : nullptr;
+
+    // if sampling blocks, track which channels get processed
+    const std::size_t nTowers   = towers -> size();
+    const std::size_t blockSize = doBlocks ? std::max<std::size_t>(m_config.sampleBlockSize, 1) : std::max<std::size_t>(nTowers, 1);
+    if (doBlocks && doCompare)
     {
+      m_sampleMask.Resize(nTowers);
+    }
+
+    // if sampling, clear tallies of towers per status, eta, and phi
+    const bool        isHCal   = (m_config.inNodeNames[iNode].second == CSMD::Calo::HCal);
+    const std::size_t nEtaBins = isHCal ? hcHistDef.eta.nBins : emHistDef.eta.nBins;
+    const std::size_t nPhiBins = isHCal ? hcHistDef.phi.nBins : emHistDef.phi.nBins;
+    if (m_config.doSampling)
+    {
+      m_nPerStat.assign(CSMD::Stat::Unknown, 0);
+      m_nPerEta.assign(CSMD::Stat::Unknown * nEtaBins, 0);
+      m_nPerPhi.assign(CSMD::Stat::Unknown * nPhiBins, 0);
+    }
 
-      // grab eta, phi indices
-      const int32_t key  = towers -> encode_key(iTower);
-      const int32_t iEta = towers -> getTowerEtaBin(key);
-      const int32_t iPhi = towers -> getTowerPhiBin(key);
+    // loop over blocks of towers
+    for (size_t iBlock = 0; (iBlock * blockSize) < nTowers; ++iBlock)
+    {
 
-      // get status
-      const auto tower  = towers -> get_tower_at_channel(iTower);
-      const auto status = CSMD::GetTowerStatus(tower);
-      if (status == CSMD::Stat::Unknown)
+      // if sampling blocks, check if this one should be processed
+      //   - n.b. skipped towers are exported as unknown
+      const std::size_t iFirst = iBlock * blockSize;
+      const std::size_t iLast  = std::min(iFirst + blockSize, nTowers);
+      if (doBlocks && !CSMD::IsSampled((((m_nEvent * m_inNodes.size()) + iNode) << 20) + iBlock, m_sampleFraction))
       {
-        std::cout << PHWHERE << ": Warning! Tower has an unknown status!\n"
-                  << "  channel = " << iTower << ", key = " << key << "\n"
-                  << "  node = " << m_config.inNodeNames[iNode].first
-                  << std::endl; 
+        for (size_t iTower = iFirst; record && (iTower < iLast); ++iTower)
+        {
+          writer -> SetStatus(record, iTower, CSMD::Stat::Unknown);
+        }
         continue;
-      } 
+      }
 
-      // make base eta/phi hist name
-      const std::string statLabel  = m_mapStatLabels[status];
-      const std::string perEtaBase = MakeBaseName("NPerEta", nodeName, statLabel);
-      const std::string perPhiBase = MakeBaseName("NPerPhi", nodeName, statLabel);
-      const std::string phiEtaBase = MakeBaseName("PhiVsEta", nodeName, statLabel);
-
-      // fill histograms accordingly
-      m_hists[statBase]   -> Fill(status);
-      m_hists[perEtaBase] -> Fill(iEta);
-      m_hists[perPhiBase] -> Fill(iPhi);
-      m_hists[phiEtaBase] -> Fill(iEta, iPhi);
-
-    }  // end tower loop
+      // loop over towers
+      for (size_t iTower = iFirst; iTower < iLast; ++iTower)
+      {
+
+        // grab eta, phi indices
+        const int32_t key  = towers -> encode_key(iTower);
+        const int32_t iEta = towers -> getTowerEtaBin(key);
+        const int32_t iPhi = towers -> getTowerPhiBin(key);
+
+        // get status
+        const auto tower  = towers -> get_tower_at_channel(iTower);
+        const auto status = CSMD::GetTowerStatus(tower);
+        if (record)
+        {
+          writer -> SetStatus(record, iTower, status);
+        }
+        if (status == CSMD::Stat::Unknown)
+        {
+          std::cout << PHWHERE << ": Warning! Tower has an unknown status!\n"
+                    << "  channel = " << iTower << ", key = " << key << "\n"
+                    << "  node = " << m_config.inNodeNames[iNode].first
+                    << std::endl; 
+          continue;
+        } 
+
+        // make base eta/phi hist name
+        const std::string statLabel  = m_mapStatLabels[status];
+        const std::string perEtaBase = MakeBaseName("NPerEta", nodeName, statLabel);
+        const std::string perPhiBase = MakeBaseName("NPerPhi", nodeName, statLabel);
+        const std::string phiEtaBase = MakeBaseName("PhiVsEta", nodeName, statLabel);
+
+        // fill histograms accordingly
+        //   - n.b. if sampling, 1d counts are tallied and filled
+        //     once per sampled unit (see FillTallies)
+        const bool doTally = m_config.doSampling
+                          && (iEta >= 0) && ((std::size_t) iEta < nEtaBins)
+                          && (iPhi >= 0) && ((std::size_t) iPhi < nPhiBins);
+        if (doTally)
+        {
+          ++m_nPerStat[status];
+          ++m_nPerEta[(status * nEtaBins) + iEta];
+          ++m_nPerPhi[(status * nPhiBins) + iPhi];
+        }
+        else
+        {
+          m_hists[statBase]   -> Fill(status, weight);
+          m_hists[perEtaBase] -> Fill(iEta, weight);
+          m_hists[perPhiBase] -> Fill(iPhi, weight);
+        }
+        static_cast<TH2*>(m_hists[phiEtaBase]) -> Fill(iEta, iPhi, weight);
+
+        // record status for comparison
+        if (doCompare)
+        {
+          obsPlanes -> second[status].Set(iTower);
+          if (doBlocks)
+          {
+            m_sampleMask.Set(iTower);
+          }
+        }
+
+      }  // end tower loop
+
+      // if sampling, fill tallies of this unit
+      //   - n.b. without block sampling, the whole
+      //     event is a single block
+      if (m_config.doSampling)
+      {
+        FillTallies(nodeName, nEtaBins, nPhiBins, weight);
+      }
+    }  // end block loop
+
+    // if needed, compare against reference
+    //   - n.b. the mismatch rate is already a fraction of the
+    //     sampled towers, so it's only weighted when sampling events
+    if (doCompare)
+    {
+      CompareToReference(nodeName, towers, doBlocks ? &m_sampleMask : nullptr, weight, doBlocks ? 1. : weight);
+    }
   }  // end node loop
 
-  // increment event no. and return
+  // increment event no., publish and update sampling
+  // if needed, and return
   ++m_nEvent;
+  if (m_publisher && ((m_nEvent % std::max<uint64_t>(m_config.shmUpdateEvents, 1)) == 0))
+  {
+    PublishMaps();
+  }
+  if (m_config.doSampling)
+  {
+    UpdateSampling(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+  }
   return Fun4AllReturnCodes::EVENT_OK;
 
 }  // end 'process_event(PHCompositeNode*)'
 
 
 
+// ----------------------------------------------------------------------------
+//! Wrap up a run
+// ----------------------------------------------------------------------------
+int CaloStatusMapper::EndRun(const int runnumber)
+{
+
+  if (m_config.debug)
+  {
+    std::cout << "CaloStatusMapper::EndRun(int) Ending run " << runnumber << std::endl;
+  }
+
+  // if needed, write out this run's maps
+  //   - n.b. if still skipping events after resuming,
+  //     this run was already written out
+  if (m_config.doPerRunOutput && (m_nEvent > 0) && (m_nToSkip == 0))
+  {
+    WriteRunOutput(runnumber);
+  }
+  return Fun4AllReturnCodes::EVENT_OK;
+
+}  // end 'EndRun(int)'
+
+
+
 // ----------------------------------------------------------------------------
 //! Run final calculations
 // ----------------------------------------------------------------------------
@@ -220,11 +540,25 @@ int CaloStatusMapper::End(PHCompositeNode* /*topNode*/)
     std::cout << "CaloStatusMapper::End(PHCompositeNode* topNode) This is the End..." << std::endl;
   }
 
+  // if needed, publish final maps before segment is closed
+  if (m_publisher)
+  {
+    PublishMaps();
+  }
+
   // normalize avg. status no.s
-  for (const auto& nodeName : m_config.inNodeNames)
+  ScaleStatus(1. / (double) m_nEvent);
+
+  // close any column files and shared-memory segment
+  CloseColumnWriters();
+  delete m_publisher;
+  m_publisher = nullptr;
+
+  // job finished cleanly, so checkpoint is no longer needed
+  if (!m_config.checkpointFile.empty())
   {
-    const std::string statBase = MakeBaseName("Status", nodeName.first);
-    m_hists[statBase] -> Scale(1. / (double) m_nEvent);
+    std::remove(m_config.checkpointFile.data());
+    std::remove((m_config.checkpointFile + ".tmp").data());
   }
 
   // register hists and exit
@@ -279,6 +613,15 @@ void CaloStatusMapper::BuildHistograms()
   const CSMD::EMCalHistDef emHistDef;
   const CSMD::HCalHistDef  hcHistDef;
 
+  // if sampling, create hist of fraction processed
+  if (m_config.doSampling)
+  {
+    m_hists["SampleFraction"] = emHistDef.MakeFrac1D(
+      CSMD::MakeQAHistName("SampleFraction", m_config.moduleName, m_config.histTag)
+    );
+    m_hists["SampleFraction"] -> GetXaxis() -> SetTitle("Fraction sampled");
+  }
+
   // loop over input node names
   for (const auto& nodeName : m_config.inNodeNames)
   {
@@ -291,12 +634,35 @@ void CaloStatusMapper::BuildHistograms()
     //   - n.b. calo type doesn't matter here
     m_hists[statBase] = emHistDef.MakeStatus1D(statName);
 
+    // if comparing to a reference, create mismatch hists
+    const bool doCompare = (m_config.refStatusFiles.count(nodeName.first) > 0);
+    if (doCompare)
+    {
+      const std::string misStatBase = MakeBaseName("Status", nodeName.first, "Mismatch");
+      const std::string misRateBase = MakeBaseName("Rate", nodeName.first, "Mismatch");
+      const std::string misMapBase  = MakeBaseName("PhiVsEta", nodeName.first, "Mismatch");
+      const std::string misStatName = CSMD::MakeQAHistName(misStatBase, m_config.moduleName, m_config.histTag);
+      const std::string misRateName = CSMD::MakeQAHistName(misRateBase, m_config.moduleName, m_config.histTag);
+      const std::string misMapName  = CSMD::MakeQAHistName(misMapBase, m_config.moduleName, m_config.histTag);
+
+      m_hists[misStatBase] = emHistDef.MakeStatus1D(misStatName);
+      m_hists[misRateBase] = emHistDef.MakeFrac1D(misRateName);
+      m_hists[misMapBase]  = (nodeName.second == CSMD::Calo::HCal)
+                           ? hcHistDef.MakePhiEta2D(misMapName)
+                           : emHistDef.MakePhiEta2D(misMapName);
+    }
+
     // loop over status labels
     for (const auto& statLabel : m_mapStatLabels)
     {
 
       // set relevant bin label for status histogram
       m_hists[statBase] -> GetXaxis() -> SetBinLabel(statLabel.first + 1, statLabel.second.data());
+      if (doCompare)
+      {
+        const std::string misStatBase = MakeBaseName("Status", nodeName.first, "Mismatch");
+        m_hists[misStatBase] -> GetXaxis() -> SetBinLabel(statLabel.first + 1, statLabel.second.data());
+      }
 
       // make base eta/phi hist name
       const std::string perEtaBase = MakeBaseName("NPerEta", nodeName.first, statLabel.second);
@@ -327,6 +693,16 @@ void CaloStatusMapper::BuildHistograms()
 
     }  // end status loop
   }  // end node loop
+
+  // if sampling, make sure uncertainties are
+  // tracked with weights
+  if (m_config.doSampling)
+  {
+    for (auto& hist : m_hists)
+    {
+      hist.second -> Sumw2();
+    }
+  }
   return;
 
 }  // end 'BuildHistograms()'
@@ -334,35 +710,980 @@ void CaloStatusMapper::BuildHistograms()
 
 
 // ----------------------------------------------------------------------------
-//! Grab input nodes
+//! Open a column file for each input node
 // ----------------------------------------------------------------------------
-void CaloStatusMapper::GrabNodes(PHCompositeNode* topNode)
+/*! The record geometry of each file is taken from the
+ *  histogram definition of the node's calorimeter. If a checkpoint
+ *  was restored, each file is reopened and trimmed to the records
+ *  it held at that checkpoint; if that fails, it's started over.
+ *  Nodes whose export was turned off before the checkpoint stay
+ *  off, and their files are left untouched.
+ */
+void CaloStatusMapper::OpenColumnWriters()
 {
 
   // print debug message
   if (m_config.debug && (Verbosity() > 0))
   {
-    std::cout << "CaloStatusMapper::GrabNodes(PHCompositeNode*) Grabbing input nodes" << std::endl;
+    std::cout << "CaloStatusMapper::OpenColumnWriters() Opening column files" << std::endl;
   }
 
-  // make sure node vector is empty
-  m_inNodes.clear();
+  // make sure no writers are left open
+  CloseColumnWriters();
 
-  // loop over nodes to grab
-  for (auto inNodeName : m_config.inNodeNames)
+  // instantiate histogram definitions
+  const CSMD::EMCalHistDef emHistDef;
+  const CSMD::HCalHistDef  hcHistDef;
+
+  // loop over input node names
+  for (const auto& nodeName : m_config.inNodeNames)
   {
-    m_inNodes.push_back(
-      findNode::getClass<TowerInfoContainer>(topNode, inNodeName.first)
-    );
-    if (!m_inNodes.back())
+
+    // grab geometry
+    const CSMD::AxisDef& eta = (nodeName.second == CSMD::Calo::HCal) ? hcHistDef.eta : emHistDef.eta;
+    const CSMD::AxisDef& phi = (nodeName.second == CSMD::Calo::HCal) ? hcHistDef.phi : emHistDef.phi;
+
+    // resume or open file
+    const std::string fileName = m_config.columnOutBase + "_" + nodeName.first + ".cols";
+    const std::size_t iWriter  = m_colWriters.size();
+    if ((iWriter < m_colRecords.size()) && (m_colRecords[iWriter] == CSMD::CheckpointNoExport))
     {
-      std::cerr << PHWHERE << ":" << " PANIC! Not able to grab node " << inNodeName.first << "! Aborting!" << std::endl;
-      assert(m_inNodes.back());
+      std::cout << "CaloStatusMapper::OpenColumnWriters() Export of node " << nodeName.first << " was turned off before checkpoint, leaving " << fileName << " as is" << std::endl;
+      m_colWriters.push_back(nullptr);
+      continue;
     }
-  }  // end input node name loop
+    m_colWriters.push_back(new CaloStatusMapperColumnWriter());
+    if (iWriter < m_colRecords.size())
+    {
+      if (m_colWriters.back() -> Resume(fileName, eta.nBins, phi.nBins, m_config.columnUseNibbles, m_colRecords[iWriter]))
+      {
+        continue;
+      }
+      std::cerr << PHWHERE << ": WARNING! Couldn't resume column file " << fileName << ", starting it over!" << std::endl;
+    }
+    m_colWriters.back() -> Open(fileName, nodeName.first, eta.nBins, phi.nBins, m_config.columnUseNibbles);
+
+  }  // end node loop
   return;
 
-}  // end 'GrabNodes(PHCompositeNode*)'
+}  // end 'OpenColumnWriters()'
+
+
+
+// ----------------------------------------------------------------------------
+//! Close and clean up column files
+// ----------------------------------------------------------------------------
+void CaloStatusMapper::CloseColumnWriters()
+{
+
+  // print debug message
+  if (m_config.debug && (Verbosity() > 0))
+  {
+    std::cout << "CaloStatusMapper::CloseColumnWriters() Closing column files" << std::endl;
+  }
+
+  for (auto* writer : m_colWriters)
+  {
+    delete writer;
+  }
+  m_colWriters.clear();
+  return;
+
+}  // end 'CloseColumnWriters()'
+
+
+
+// ----------------------------------------------------------------------------
+//! Create shared-memory segment for live maps
+// ----------------------------------------------------------------------------
+void CaloStatusMapper::OpenPublisher()
+{
+
+  // print debug message
+  if (m_config.debug && (Verbosity() > 0))
+  {
+    std::cout << "CaloStatusMapper::OpenPublisher() Opening shared-memory segment" << std::endl;
+  }
+
+  // instantiate histogram definitions
+  const CSMD::EMCalHistDef emHistDef;
+  const CSMD::HCalHistDef  hcHistDef;
+
+  // describe each node
+  std::vector<CaloStatusMapperShm::NodeInfo> nodes;
+  for (const auto& nodeName : m_config.inNodeNames)
+  {
+    CaloStatusMapperShm::NodeInfo node {};
+    std::strncpy(node.name, nodeName.first.data(), sizeof(node.name) - 1);
+    node.nEta  = (nodeName.second == CSMD::Calo::HCal) ? hcHistDef.eta.nBins : emHistDef.eta.nBins;
+    node.nPhi  = (nodeName.second == CSMD::Calo::HCal) ? hcHistDef.phi.nBins : emHistDef.phi.nBins;
+    node.nStat = m_mapStatLabels.size();
+    nodes.push_back(node);
+  }
+
+  // collect status labels
+  std::vector<std::string> labels;
+  for (const auto& statLabel : m_mapStatLabels)
+  {
+    labels.push_back(statLabel.second);
+  }
+
+  // and open segment
+  delete m_publisher;
+  m_publisher = new CaloStatusMapperShmPublisher();
+  if (!m_publisher -> Open(m_config.shmName, nodes, labels))
+  {
+    delete m_publisher;
+    m_publisher = nullptr;
+    return;
+  }
+  std::cout << "CaloStatusMapper::OpenPublisher() Publishing status maps to shared-memory segment " << m_config.shmName << std::endl;
+  return;
+
+}  // end 'OpenPublisher()'
+
+
+
+// ----------------------------------------------------------------------------
+//! Copy current maps into shared memory
+// ----------------------------------------------------------------------------
+/*! Maps are written into the publisher's inactive buffer, which
+ *  is then flipped to active, so attached readers never block
+ *  the event loop.
+ */
+void CaloStatusMapper::PublishMaps()
+{
+
+  // print debug message
+  if (m_config.debug && (Verbosity() > 1))
+  {
+    std::cout << "CaloStatusMapper::PublishMaps() Publishing status maps" << std::endl;
+  }
+
+  double* buffer = m_publisher -> BeginUpdate();
+  for (size_t iNode = 0; iNode < std::min(m_config.inNodeNames.size(), CaloStatusMapperShm::MaxNodes); ++iNode)
+  {
+    const std::string                    nodeName = m_config.inNodeNames[iNode].first;
+    const CaloStatusMapperShm::NodeInfo& node     = m_publisher -> GetNode(iNode);
+    for (const auto& statLabel : m_mapStatLabels)
+    {
+      const TH1* hist = m_hists[MakeBaseName("PhiVsEta", nodeName, statLabel.second)];
+      double*    map  = buffer + node.offset + ((size_t) statLabel.first * node.nEta * node.nPhi);
+      for (uint32_t iPhi = 0; iPhi < node.nPhi; ++iPhi)
+      {
+        for (uint32_t iEta = 0; iEta < node.nEta; ++iEta)
+        {
+          map[(iPhi * node.nEta) + iEta] = hist -> GetBinContent(iEta + 1, iPhi + 1);
+        }
+      }
+    }
+  }
+  m_publisher -> EndUpdate(m_nEvent);
+  return;
+
+}  // end 'PublishMaps()'
+
+
+
+// ----------------------------------------------------------------------------
+//! Write accumulated state to checkpoint file
+// ----------------------------------------------------------------------------
+/*! The state (event counts, run and event no. of the event about to
+ *  be counted, sampling state, no. of records in each column file,
+ *  and the contents of every histogram) is written to a temporary
+ *  file which then
+ *  replaces the checkpoint file, so a preemption mid-write never
+ *  leaves a corrupt checkpoint. Only non-empty bins are stored.
+ *  Returns false if the checkpoint couldn't be written.
+ */
+bool CaloStatusMapper::WriteCheckpoint(EventHeader* header)
+{
+
+  // print debug message
+  if (m_config.debug && (Verbosity() > 0))
+  {
+    std::cout << "CaloStatusMapper::WriteCheckpoint() Writing checkpoint after " << m_nSeen << " events" << std::endl;
+  }
+
+  const std::string tmpFile = m_config.checkpointFile + ".tmp";
+  std::ofstream output(tmpFile, std::ios::binary | std::ios::trunc);
+  if (!output.is_open())
+  {
+    return false;
+  }
+  auto put = [&output](const auto& value) {
+    output.write(reinterpret_cast<const char*>(&value), sizeof(value));
+  };
+
+  // write event counts and sampling state
+  output.write(CSMD::CheckpointMagic, sizeof(CSMD::CheckpointMagic));
+  put(CSMD::CheckpointVersion);
+  put(m_nSeen);
+  put(m_nEvent);
+  put(static_cast<uint8_t>(header != nullptr));
+  put(header ? static_cast<uint64_t>(header -> get_RunNumber()) : static_cast<uint64_t>(0));
+  put(header ? static_cast<uint64_t>(header -> get_EvtSequence()) : static_cast<uint64_t>(0));
+  put(m_sampleFraction);
+  put(m_sampleTime);
+  put(m_sampleWindow);
+
+  // flush column files and write their no. of records
+  //   - n.b. nodes whose export was turned off are marked
+  //     so that their files are left alone on resume
+  put(static_cast<uint32_t>(m_colWriters.size()));
+  for (auto* writer : m_colWriters)
+  {
+    if (writer)
+    {
+      writer -> Flush();
+    }
+    put(writer ? writer -> GetNRecords() : CSMD::CheckpointNoExport);
+  }
+  put(static_cast<uint32_t>(m_hists.size()));
+
+  // write non-empty bins of each histogram
+  for (const auto& hist : m_hists)
+  {
+
+    // collect non-empty bins
+    const TH1*     histo   = hist.second;
+    const uint32_t nCells  = histo -> GetNcells();
+    const bool     doSumw2 = (histo -> GetSumw2N() > 0);
+    std::vector<uint32_t> bins;
+    for (uint32_t iCell = 0; iCell < nCells; ++iCell)
+    {
+      if (histo -> GetBinContent(iCell) != 0.)
+      {
+        bins.push_back(iCell);
+      }
+    }
+
+    // write header
+    std::array<double, CSMD::NStats> stats {};
+    histo -> GetStats(stats.data());
+    put(static_cast<uint32_t>(hist.first.size()));
+    output.write(hist.first.data(), hist.first.size());
+    put(nCells);
+    put(static_cast<uint8_t>(doSumw2));
+    put(histo -> GetEntries());
+    put(stats);
+    put(static_cast<uint32_t>(bins.size()));
+
+    // and bins
+    for (const uint32_t iCell : bins)
+    {
+      put(iCell);
+      put(histo -> GetBinContent(iCell));
+      if (doSumw2)
+      {
+        put(histo -> GetBinError(iCell) * histo -> GetBinError(iCell));
+      }
+    }
+  }  // end hist loop
+  output.close();
+
+  // replace previous checkpoint
+  return output && (std::rename(tmpFile.data(), m_config.checkpointFile.data()) == 0);
+
+}  // end 'WriteCheckpoint()'
+
+
+
+// ----------------------------------------------------------------------------
+//! Restore accumulated state from checkpoint file
+// ----------------------------------------------------------------------------
+/*! Returns false (leaving the module's state freshly initialized)
+ *  if there's no checkpoint or it doesn't match the histograms
+ *  this configuration builds.
+ */
+bool CaloStatusMapper::ReadCheckpoint()
+{
+
+  // print debug message
+  if (m_config.debug && (Verbosity() > 0))
+  {
+    std::cout << "CaloStatusMapper::ReadCheckpoint() Reading checkpoint" << std::endl;
+  }
+
+  std::ifstream input(m_config.checkpointFile, std::ios::binary);
+  if (!input.is_open())
+  {
+    std::cout << "CaloStatusMapper::ReadCheckpoint() No checkpoint found, starting from scratch" << std::endl;
+    return false;
+  }
+  auto get = [&input](auto& value) -> bool {
+    input.read(reinterpret_cast<char*>(&value), sizeof(value));
+    return static_cast<bool>(input);
+  };
+
+  // check format
+  char     magic[sizeof(CSMD::CheckpointMagic)] {};
+  uint32_t version = 0;
+  input.read(magic, sizeof(magic));
+  if (!input || (std::memcmp(magic, CSMD::CheckpointMagic, sizeof(magic)) != 0) || !get(version) || (version != CSMD::CheckpointVersion))
+  {
+    std::cerr << PHWHERE << ": WARNING! " << m_config.checkpointFile << " is not a valid checkpoint!" << std::endl;
+    return false;
+  }
+
+  // read event counts and sampling state
+  uint64_t nSeen        = 0;
+  uint64_t nEvent       = 0;
+  uint8_t  hasKey       = 0;
+  uint64_t resumeRun    = 0;
+  uint64_t resumeEvent  = 0;
+  double   sampleFrac   = 1.;
+  double   sampleTime   = 0.;
+  uint64_t sampleWindow = 0;
+  bool     isGood       = get(nSeen) && get(nEvent) && get(hasKey) && get(resumeRun) && get(resumeEvent)
+                       && get(sampleFrac) && get(sampleTime) && get(sampleWindow);
+
+  // read no. of records in each column file
+  uint32_t nWriters = 0;
+  isGood = isGood && get(nWriters) && (nWriters <= m_config.inNodeNames.size());
+  std::vector<uint64_t> colRecords(isGood ? nWriters : 0, 0);
+  for (auto& nRecords : colRecords)
+  {
+    isGood = isGood && get(nRecords);
+  }
+  isGood = isGood && (!m_config.doColumnExport || (colRecords.size() == m_config.inNodeNames.size()));
+
+  // read no. of histograms
+  uint32_t nHists = 0;
+  isGood = isGood && get(nHists) && (nHists == m_hists.size());
+
+  // read histograms
+  for (uint32_t iHist = 0; isGood && (iHist < nHists); ++iHist)
+  {
+
+    // read header and find matching histogram
+    uint32_t    nName = 0;
+    std::string name;
+    isGood = get(nName);
+    if (isGood)
+    {
+      name.resize(nName);
+      isGood = static_cast<bool>(input.read(name.data(), nName));
+    }
+    const auto hist = m_hists.find(name);
+    isGood = isGood && (hist != m_hists.end());
+
+    uint32_t nCells  = 0;
+    uint8_t  doSumw2 = 0;
+    double   entries = 0.;
+    uint32_t nBins   = 0;
+    std::array<double, CSMD::NStats> stats {};
+    isGood = isGood && get(nCells) && get(doSumw2) && get(entries) && get(stats) && get(nBins);
+    isGood = isGood && (nCells == (uint32_t) hist -> second -> GetNcells());
+    if (!isGood)
+    {
+      break;
+    }
+
+    // restore bins
+    TH1* histo = hist -> second;
+    if (doSumw2 && (histo -> GetSumw2N() == 0))
+    {
+      histo -> Sumw2();
+    }
+    for (uint32_t iBin = 0; isGood && (iBin < nBins); ++iBin)
+    {
+      uint32_t iCell   = 0;
+      double   content = 0.;
+      double   sumw2   = 0.;
+      isGood = get(iCell) && get(content) && (!doSumw2 || get(sumw2)) && (iCell < nCells);
+      if (isGood)
+      {
+        histo -> SetBinContent(iCell, content);
+        if (doSumw2)
+        {
+          histo -> GetSumw2() -> GetArray()[iCell] = sumw2;
+        }
+      }
+    }
+    histo -> SetEntries(entries);
+    histo -> PutStats(stats.data());
+
+  }  // end hist loop
+
+  // if anything didn't match, start from scratch
+  if (!isGood)
+  {
+    std::cerr << PHWHERE << ": WARNING! Checkpoint " << m_config.checkpointFile << " doesn't match this configuration! Starting from scratch." << std::endl;
+    ResetHistograms();
+    return false;
+  }
+
+  m_nSeen          = nSeen;
+  m_nEvent         = nEvent;
+  m_hasResumeKey   = (hasKey != 0);
+  m_resumeRun      = resumeRun;
+  m_resumeEvent    = resumeEvent;
+  m_sampleFraction = sampleFrac;
+  m_sampleTime     = sampleTime;
+  m_sampleWindow   = sampleWindow;
+  m_colRecords     = colRecords;
+  std::cout << "CaloStatusMapper::ReadCheckpoint() Resuming after " << m_nSeen << " events" << std::endl;
+  return true;
+
+}  // end 'ReadCheckpoint()'
+
+
+
+// ----------------------------------------------------------------------------
+//! Grab input nodes
+// ----------------------------------------------------------------------------
+void CaloStatusMapper::GrabNodes(PHCompositeNode* topNode)
+{
+
+  // print debug message
+  if (m_config.debug && (Verbosity() > 0))
+  {
+    std::cout << "CaloStatusMapper::GrabNodes(PHCompositeNode*) Grabbing input nodes" << std::endl;
+  }
+
+  // make sure node vector is empty
+  m_inNodes.clear();
+
+  // loop over nodes to grab
+  for (auto inNodeName : m_config.inNodeNames)
+  {
+    m_inNodes.push_back(
+      findNode::getClass<TowerInfoContainer>(topNode, inNodeName.first)
+    );
+    if (!m_inNodes.back())
+    {
+      std::cerr << PHWHERE << ":" << " PANIC! Not able to grab node " << inNodeName.first << "! Aborting!" << std::endl;
+      assert(m_inNodes.back());
+    }
+  }  // end input node name loop
+  return;
+
+}  // end 'GrabNodes(PHCompositeNode*)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Load reference status maps
+// ----------------------------------------------------------------------------
+/*! Reference bits are sized to the input nodes and reused between
+ *  runs. Any channel not assigned a status by the reference is taken
+ *  to be good.
+ *
+ *  A text reference defines every status, while a CDBTTree only
+ *  defines which towers are hot; only the defined statuses are
+ *  compared later on.
+ */
+void CaloStatusMapper::LoadReferences()
+{
+
+  // print debug message
+  if (m_config.debug && (Verbosity() > 0))
+  {
+    std::cout << "CaloStatusMapper::LoadReferences() Loading reference status maps" << std::endl;
+  }
+
+  // loop over input nodes
+  for (size_t iNode = 0; iNode < m_inNodes.size(); ++iNode)
+  {
+
+    // check if node has a reference
+    const std::string nodeName = m_config.inNodeNames[iNode].first;
+    const auto refFile = m_config.refStatusFiles.find(nodeName);
+    if (refFile == m_config.refStatusFiles.end())
+    {
+      continue;
+    }
+
+    // size reference & observed bits
+    //   - n.b. unknown status isn't tracked
+    TowerInfoContainer* towers    = m_inNodes[iNode];
+    const std::size_t   nChannels = towers -> size();
+    CSMD::StatusPlanes& refPlanes = m_refPlanes[nodeName];
+    CSMD::StatusPlanes& obsPlanes = m_obsPlanes[nodeName];
+    refPlanes.resize(CSMD::Stat::Unknown);
+    obsPlanes.resize(CSMD::Stat::Unknown);
+    for (std::size_t iStat = 0; iStat < refPlanes.size(); ++iStat)
+    {
+      refPlanes[iStat].Resize(nChannels);
+      obsPlanes[iStat].Resize(nChannels);
+    }
+    m_diffBits.Resize(std::max(m_diffBits.words.size() * 64, nChannels));
+
+    // read in reference and note which statuses it defines
+    const std::string& fileName = refFile -> second;
+    const bool isRootFile = (fileName.size() > 5) && (fileName.compare(fileName.size() - 5, 5, ".root") == 0);
+    std::vector<std::size_t>& refStats = m_refStats[nodeName];
+    refStats.clear();
+    if (isRootFile)
+    {
+      ReadReferenceCDB(fileName, towers, refPlanes);
+      refStats.push_back(CSMD::Stat::Hot);
+    }
+    else
+    {
+      ReadReferenceText(fileName, nChannels, refPlanes);
+      for (std::size_t iStat = 0; iStat < refPlanes.size(); ++iStat)
+      {
+        refStats.push_back(iStat);
+      }
+    }
+
+    // mark unassigned channels as good
+    for (std::size_t iChannel = 0; iChannel < nChannels; ++iChannel)
+    {
+      const bool isAssigned = std::any_of(
+        refPlanes.begin(),
+        refPlanes.end(),
+        [iChannel](const CSMD::StatusBits& plane) { return plane.Test(iChannel); }
+      );
+      if (!isAssigned)
+      {
+        refPlanes[CSMD::Stat::Good].Set(iChannel);
+      }
+    }
+  }  // end input node loop
+  return;
+
+}  // end 'LoadReferences()'
+
+
+
+// ----------------------------------------------------------------------------
+//! Read reference status map from a text file
+// ----------------------------------------------------------------------------
+/*! Each line should hold a channel index and a status code, e.g.
+ *
+ *      <channel> <status>
+ *
+ *  Blank lines and lines starting with '#' are ignored.
+ */
+void CaloStatusMapper::ReadReferenceText(
+  const std::string& file,
+  const std::size_t nChannels,
+  CSMD::StatusPlanes& planes) const
+{
+
+  // print debug message
+  if (m_config.debug && (Verbosity() > 0))
+  {
+    std::cout << "CaloStatusMapper::ReadReferenceText(std::string&, std::size_t, StatusPlanes&) Reading " << file << std::endl;
+  }
+
+  std::ifstream input(file);
+  if (!input.is_open())
+  {
+    std::cerr << PHWHERE << ": WARNING! Couldn't open reference file " << file << "!" << std::endl;
+    return;
+  }
+
+  // loop over lines
+  std::string line;
+  while (std::getline(input, line))
+  {
+
+    // skip comments, blank lines
+    if (line.empty() || (line[0] == '#'))
+    {
+      continue;
+    }
+
+    // parse channel and status
+    std::istringstream parser(line);
+    std::size_t channel = 0;
+    int         status  = 0;
+    if (!(parser >> channel >> status) || (channel >= nChannels) || (status < 0) || (status >= CSMD::Stat::Unknown))
+    {
+      std::cerr << PHWHERE << ": WARNING! Bad line in reference file " << file << ":\n"
+                << "  " << line
+                << std::endl;
+      continue;
+    }
+    planes[status].Set(channel);
+
+  }  // end line loop
+  return;
+
+}  // end 'ReadReferenceText(std::string&, std::size_t, StatusPlanes&)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Read reference status map from a local CDBTTree
+// ----------------------------------------------------------------------------
+/*! This mirrors the hot map in the conditions database, where
+ *  channels are keyed by tower key and any non-zero value marks
+ *  a tower as hot. Channels absent from the tree are left
+ *  unassigned.
+ */
+void CaloStatusMapper::ReadReferenceCDB(
+  const std::string& file,
+  TowerInfoContainer* towers,
+  CSMD::StatusPlanes& planes) const
+{
+
+  // print debug message
+  if (m_config.debug && (Verbosity() > 0))
+  {
+    std::cout << "CaloStatusMapper::ReadReferenceCDB(std::string&, TowerInfoContainer*, StatusPlanes&) Reading " << file << std::endl;
+  }
+
+  CDBTTree cdbttree(file);
+  cdbttree.LoadCalibrations();
+  for (std::size_t iChannel = 0; iChannel < towers -> size(); ++iChannel)
+  {
+    // skip channels missing from the tree, they're
+    // marked as good along with other unassigned channels
+    const int32_t key   = towers -> encode_key(iChannel);
+    const int     value = cdbttree.GetIntValue(key, m_config.refFieldName, false);
+    if (value == std::numeric_limits<int>::min())
+    {
+      continue;
+    }
+    planes[(value != 0) ? CSMD::Stat::Hot : CSMD::Stat::Good].Set(iChannel);
+  }
+  return;
+
+}  // end 'ReadReferenceCDB(std::string&, TowerInfoContainer*, StatusPlanes&)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Compare observed status bits against reference
+// ----------------------------------------------------------------------------
+/*! Each status plane the reference defines is XOR'd against the
+ *  reference a word at a time. E.g. for a CDBTTree hot map, only
+ *  the hot plane is compared, so towers flagged for timing, chi2,
+ *  etc. don't count as disagreements. Disagreeing channels are then
+ *  counted via popcount under their observed status (so each counts
+ *  once), and only those (typically few) channels are unpacked to
+ *  fill the map. If a mask is provided (e.g. when sampling blocks of
+ *  towers), only the masked channels are compared.
+ *
+ *  Counts are filled with weight, while the per-event mismatch rate
+ *  is filled with rateWeight, since a rate over sampled towers
+ *  shouldn't be scaled up for towers that were skipped.
+ */
+void CaloStatusMapper::CompareToReference(
+  const std::string& node,
+  TowerInfoContainer* towers,
+  const CSMD::StatusBits* mask,
+  const double weight,
+  const double rateWeight)
+{
+
+  // print debug message
+  if (m_config.debug && (Verbosity() > 1))
+  {
+    std::cout << "CaloStatusMapper::CompareToReference(std::string&, TowerInfoContainer*, StatusBits*, double x 2) Comparing to reference" << std::endl;
+  }
+
+  // grab bits and make hist names
+  const CSMD::StatusPlanes&       refPlanes = m_refPlanes[node];
+  const CSMD::StatusPlanes&       obsPlanes = m_obsPlanes[node];
+  const std::vector<std::size_t>& refStats  = m_refStats[node];
+  const std::string misStatBase = MakeBaseName("Status", node, "Mismatch");
+  const std::string misRateBase = MakeBaseName("Rate", node, "Mismatch");
+  const std::string misMapBase  = MakeBaseName("PhiVsEta", node, "Mismatch");
+
+  // xor each defined status against reference
+  const std::size_t nWords = refPlanes.front().words.size();
+  std::fill(m_diffBits.words.begin(), m_diffBits.words.begin() + nWords, 0);
+  for (const std::size_t iStat : refStats)
+  {
+    for (std::size_t iWord = 0; iWord < nWords; ++iWord)
+    {
+      uint64_t diff = obsPlanes[iStat].words[iWord] ^ refPlanes[iStat].words[iWord];
+      if (mask)
+      {
+        diff &= mask -> words[iWord];
+      }
+      m_diffBits.words[iWord] |= diff;
+    }
+  }
+
+  // count disagreeing channels by observed status
+  for (std::size_t iStat = 0; iStat < obsPlanes.size(); ++iStat)
+  {
+    uint64_t nMismatch = 0;
+    for (std::size_t iWord = 0; iWord < nWords; ++iWord)
+    {
+      nMismatch += __builtin_popcountll(m_diffBits.words[iWord] & obsPlanes[iStat].words[iWord]);
+    }
+    m_hists[misStatBase] -> Fill(iStat, weight * nMismatch);
+  }
+
+  // count disagreeing channels and fill map
+  uint64_t nDisagree = 0;
+  uint64_t nCompared = mask ? 0 : towers -> size();
+  for (std::size_t iWord = 0; iWord < nWords; ++iWord)
+  {
+    uint64_t word = m_diffBits.words[iWord];
+    nDisagree += __builtin_popcountll(word);
+    if (mask)
+    {
+      nCompared += __builtin_popcountll(mask -> words[iWord]);
+    }
+    while (word != 0)
+    {
+      const std::size_t iChannel = (iWord << 6) + __builtin_ctzll(word);
+      const int32_t     key      = towers -> encode_key(iChannel);
+      static_cast<TH2*>(m_hists[misMapBase]) -> Fill(towers -> getTowerEtaBin(key), towers -> getTowerPhiBin(key), weight);
+      word &= word - 1;
+    }
+  }
+  if (nCompared > 0)
+  {
+    m_hists[misRateBase] -> Fill((double) nDisagree / (double) nCompared, rateWeight);
+  }
+  return;
+
+}  // end 'CompareToReference(std::string&, TowerInfoContainer*, StatusBits*, double x 2)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Reset event counts, sampling, and checkpoint state
+// ----------------------------------------------------------------------------
+void CaloStatusMapper::ResetCounters()
+{
+
+  // print debug message
+  if (m_config.debug && (Verbosity() > 0))
+  {
+    std::cout << "CaloStatusMapper::ResetCounters() Resetting counters" << std::endl;
+  }
+
+  m_nEvent         = 0;
+  m_sampleFraction = std::clamp(m_config.sampleFraction, m_config.sampleMinFraction, 1.);
+  m_sampleTime     = 0.;
+  m_sampleWindow   = 0;
+  m_nSeen          = 0;
+  m_nToSkip        = 0;
+  m_nCheckpoint    = 0;
+  m_doVerifyResume = false;
+  m_hasResumeKey   = false;
+  m_colRecords.clear();
+  return;
+
+}  // end 'ResetCounters()'
+
+
+
+// ----------------------------------------------------------------------------
+//! Fill and clear tallies of towers in a sampled unit
+// ----------------------------------------------------------------------------
+/*! Towers in an event (or block) are kept or dropped together, so
+ *  the sampling variance scales like (weight * count)^2. Filling each
+ *  tally once with weight * count makes the stored uncertainties
+ *  reflect that, whereas a fill per tower would underestimate them
+ *  by roughly the square root of the count.
+ */
+void CaloStatusMapper::FillTallies(
+  const std::string& node,
+  const std::size_t nEtaBins,
+  const std::size_t nPhiBins,
+  const double weight)
+{
+
+  // print debug message
+  if (m_config.debug && (Verbosity() > 2))
+  {
+    std::cout << "CaloStatusMapper::FillTallies(std::string&, std::size_t x 2, double) Filling tallies" << std::endl;
+  }
+
+  for (std::size_t iStat = 0; iStat < m_nPerStat.size(); ++iStat)
+  {
+
+    // skip statuses no towers had
+    if (m_nPerStat[iStat] == 0)
+    {
+      continue;
+    }
+
+    // fill status count
+    const std::string statLabel = m_mapStatLabels[static_cast<CSMD::Stat>(iStat)];
+    m_hists[MakeBaseName("Status", node)] -> Fill(iStat, weight * m_nPerStat[iStat]);
+    m_nPerStat[iStat] = 0;
+
+    // and eta, phi counts
+    TH1* perEta = m_hists[MakeBaseName("NPerEta", node, statLabel)];
+    TH1* perPhi = m_hists[MakeBaseName("NPerPhi", node, statLabel)];
+    for (std::size_t iEta = 0; iEta < nEtaBins; ++iEta)
+    {
+      uint32_t& count = m_nPerEta[(iStat * nEtaBins) + iEta];
+      if (count > 0)
+      {
+        perEta -> Fill(iEta, weight * count);
+        count = 0;
+      }
+    }
+    for (std::size_t iPhi = 0; iPhi < nPhiBins; ++iPhi)
+    {
+      uint32_t& count = m_nPerPhi[(iStat * nPhiBins) + iPhi];
+      if (count > 0)
+      {
+        perPhi -> Fill(iPhi, weight * count);
+        count = 0;
+      }
+    }
+  }  // end status loop
+  return;
+
+}  // end 'FillTallies(std::string&, std::size_t x 2, double)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Adjust sampling fraction against target time
+// ----------------------------------------------------------------------------
+/*! Every sampleUpdateEvents events, the fraction is rescaled by the
+ *  ratio of the target to the avg. time spent per event (which
+ *  includes skipped events), i.e. assuming cost scales linearly with
+ *  the fraction processed.
+ */
+void CaloStatusMapper::UpdateSampling(const double time)
+{
+
+  // print debug message
+  if (m_config.debug && (Verbosity() > 1))
+  {
+    std::cout << "CaloStatusMapper::UpdateSampling(double) Updating sampling fraction" << std::endl;
+  }
+
+  m_sampleTime += time;
+  ++m_sampleWindow;
+  if (m_sampleWindow < std::max<uint64_t>(m_config.sampleUpdateEvents, 1))
+  {
+    return;
+  }
+
+  // rescale fraction
+  const double avgTime = m_sampleTime / (double) m_sampleWindow;
+  if (avgTime > 0.)
+  {
+    m_sampleFraction = std::clamp(
+      m_sampleFraction * (m_config.sampleTargetTime / avgTime),
+      m_config.sampleMinFraction,
+      1.
+    );
+  }
+
+  // and start a new window
+  m_sampleTime   = 0.;
+  m_sampleWindow = 0;
+  return;
+
+}  // end 'UpdateSampling(double)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Reset contents of all histograms
+// ----------------------------------------------------------------------------
+void CaloStatusMapper::ResetHistograms()
+{
+
+  // print debug message
+  if (m_config.debug && (Verbosity() > 0))
+  {
+    std::cout << "CaloStatusMapper::ResetHistograms() Resetting histograms" << std::endl;
+  }
+
+  for (auto& hist : m_hists)
+  {
+    hist.second -> Reset("ICES");
+  }
+  return;
+
+}  // end 'ResetHistograms()'
+
+
+
+// ----------------------------------------------------------------------------
+//! Scale avg. status histograms
+// ----------------------------------------------------------------------------
+void CaloStatusMapper::ScaleStatus(const double scale)
+{
+
+  // print debug message
+  if (m_config.debug && (Verbosity() > 0))
+  {
+    std::cout << "CaloStatusMapper::ScaleStatus(double) Scaling status histograms" << std::endl;
+  }
+
+  for (const auto& nodeName : m_config.inNodeNames)
+  {
+    const std::string statBase = MakeBaseName("Status", nodeName.first);
+    m_hists[statBase] -> Scale(scale);
+
+    // also scale avg. no. of mismatches if needed
+    const auto misStat = m_hists.find(MakeBaseName("Status", nodeName.first, "Mismatch"));
+    if (misStat != m_hists.end())
+    {
+      misStat -> second -> Scale(scale);
+    }
+  }
+  return;
+
+}  // end 'ScaleStatus(double)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Write current histograms to a per-run file
+// ----------------------------------------------------------------------------
+/*! The avg. status histograms are written as normalized clones,
+ *  so the accumulated counts are left untouched for End().
+ */
+void CaloStatusMapper::WriteRunOutput(const int runnumber)
+{
+
+  // print debug message
+  if (m_config.debug && (Verbosity() > 0))
+  {
+    std::cout << "CaloStatusMapper::WriteRunOutput(int) Writing output for run " << runnumber << std::endl;
+  }
+
+  // make sure we leave the current directory untouched
+  TDirectory::TContext context;
+
+  const std::string fileName = m_config.perRunOutBase + "_run" + std::to_string(runnumber) + ".root";
+  TFile file(fileName.data(), "recreate");
+  if (file.IsZombie())
+  {
+    std::cerr << PHWHERE << ": WARNING! Couldn't open per-run output file " << fileName << "!" << std::endl;
+    return;
+  }
+
+  // collect avg. status histograms to normalize
+  std::set<std::string> toScale;
+  for (const auto& nodeName : m_config.inNodeNames)
+  {
+    toScale.insert(MakeBaseName("Status", nodeName.first));
+    toScale.insert(MakeBaseName("Status", nodeName.first, "Mismatch"));
+  }
+
+  // write histograms, normalizing copies where needed
+  for (const auto& hist : m_hists)
+  {
+    if (toScale.count(hist.first) == 0)
+    {
+      file.WriteTObject(hist.second);
+      continue;
+    }
+
+    TH1* scaled = static_cast<TH1*>(hist.second -> Clone());
+    scaled -> SetDirectory(nullptr);
+    scaled -> Scale(1. / (double) m_nEvent);
+    file.WriteTObject(scaled);
+    delete scaled;
+  }
+
+  file.Close();
+  return;
+
+}  // end 'WriteRunOutput(int)'
 
 
 
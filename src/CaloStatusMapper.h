@@ -30,6 +30,9 @@
 #include <vector>
 
 // forward declarations
+class CaloStatusMapperColumnWriter;
+class CaloStatusMapperShmPublisher;
+class EventHeader;
 class PHCompositeNode;
 class Fun4AllHistoManager;
 class TH1;
@@ -77,6 +80,67 @@ class CaloStatusMapper : public SubsysReco
      ///! trigger to select
      uint32_t trgToSelect {JetQADefs::GL1::MBDNSJet1};
 
+     ///! turn per-run output on/off
+     bool doPerRunOutput {false};
+
+     ///! base of per-run output files (<base>_run<no.>.root)
+     std::string perRunOutBase {"calostatusmapper"};
+
+     ///! reference status maps to compare against, keyed by node name
+     ///!   - text files hold "<channel> <status code>" per line
+     ///!   - root files are read as a local CDBTTree
+     std::map<std::string, std::string> refStatusFiles {};
+
+     ///! field to read from reference CDBTTree files
+     std::string refFieldName {"status"};
+
+     ///! turn export of per-event status codes on/off
+     bool doColumnExport {false};
+
+     ///! base of column files (<base>_<node>.cols)
+     std::string columnOutBase {"calostatusmapper"};
+
+     ///! store status codes as nibbles rather than bytes
+     bool columnUseNibbles {false};
+
+     ///! turn adaptive sampling on/off
+     bool doSampling {false};
+
+     ///! what to sample (events or blocks of towers)
+     CaloStatusMapperDefs::Sample sampleMode {CaloStatusMapperDefs::Sample::Events};
+
+     ///! no. of towers per block when sampling blocks
+     std::size_t sampleBlockSize {64};
+
+     ///! starting and minimum fraction of events/blocks to process
+     double sampleFraction {1.};
+     double sampleMinFraction {0.01};
+
+     ///! target processing time per event [us]
+     double sampleTargetTime {1000.};
+
+     ///! no. of events between adjustments of the fraction
+     uint64_t sampleUpdateEvents {100};
+
+     ///! turn live shared-memory export on/off
+     bool doShmExport {false};
+
+     ///! name of shared-memory segment
+     std::string shmName {"/calostatusmapper"};
+
+     ///! no. of events between updates of the segment
+     uint64_t shmUpdateEvents {1000};
+
+     ///! file to checkpoint accumulated state to (empty turns it off)
+     std::string checkpointFile {""};
+
+     ///! no. of events between checkpoints
+     uint64_t checkpointEvents {10000};
+
+     ///! restore state from checkpoint file at Init and
+     ///! skip events it already covers (cf. GetNEventsToSkip)
+     bool doResume {false};
+
     };  // end Config
 
     // ctor/dtor
@@ -88,11 +152,14 @@ class CaloStatusMapper : public SubsysReco
     void SetConfig(const Config& config) {m_config = config;}
 
     // getters
-    Config GetConfig() {return m_config;}
+    Config   GetConfig() {return m_config;}
+    uint64_t GetNEventsToSkip() const {return m_nToSkip;}
 
     // f4a methods
     int Init(PHCompositeNode* /*topNode*/) override;
+    int InitRun(PHCompositeNode* /*topNode*/) override;
     int process_event(PHCompositeNode* topNode) override;
+    int EndRun(const int runnumber) override;
     int End(PHCompositeNode* /*topNode*/) override;
 
   private:
@@ -100,7 +167,23 @@ class CaloStatusMapper : public SubsysReco
     // private methods
     void InitHistManager();
     void BuildHistograms();
+    void OpenColumnWriters();
+    void CloseColumnWriters();
+    void OpenPublisher();
+    void PublishMaps();
+    bool WriteCheckpoint(EventHeader* header);
+    bool ReadCheckpoint();
     void GrabNodes(PHCompositeNode* topNode);
+    void LoadReferences();
+    void ReadReferenceText(const std::string& file, const std::size_t nChannels, CaloStatusMapperDefs::StatusPlanes& planes) const;
+    void ReadReferenceCDB(const std::string& file, TowerInfoContainer* towers, CaloStatusMapperDefs::StatusPlanes& planes) const;
+    void CompareToReference(const std::string& node, TowerInfoContainer* towers, const CaloStatusMapperDefs::StatusBits* mask, const double weight, const double rateWeight);
+    void FillTallies(const std::string& node, const std::size_t nEtaBins, const std::size_t nPhiBins, const double weight);
+    void UpdateSampling(const double time);
+    void ResetCounters();
+    void ResetHistograms();
+    void ScaleStatus(const double scale);
+    void WriteRunOutput(const int runnumber);
     std::string MakeBaseName(const std::string& base, const std::string& node, const std::string& stat = "") const;
 
     ///! module configuration
@@ -121,9 +204,71 @@ class CaloStatusMapper : public SubsysReco
     ///! input nodes
     std::vector<TowerInfoContainer*> m_inNodes;
 
+    ///! reference status bits, keyed by node name
+    std::map<std::string, CaloStatusMapperDefs::StatusPlanes> m_refPlanes;
+
+    ///! statuses each node's reference actually defines, keyed by node name
+    std::map<std::string, std::vector<std::size_t>> m_refStats;
+
+    ///! observed status bits of current event, keyed by node name
+    std::map<std::string, CaloStatusMapperDefs::StatusPlanes> m_obsPlanes;
+
+    ///! scratch bits for channels which disagree with reference
+    CaloStatusMapperDefs::StatusBits m_diffBits;
+
+    ///! writers of per-event status codes, one per input node
+    std::vector<CaloStatusMapperColumnWriter*> m_colWriters;
+
+    ///! publisher of live status maps
+    CaloStatusMapperShmPublisher* m_publisher {nullptr};
+
+    ///! current fraction of events/blocks to process
+    double m_sampleFraction {1.};
+
+    ///! time spent [us] and no. of events in current sampling window
+    double   m_sampleTime {0.};
+    uint64_t m_sampleWindow {0};
+
+    ///! scratch bits for channels sampled in current event
+    CaloStatusMapperDefs::StatusBits m_sampleMask;
+
+    ///! tallies of towers per status, status x eta, and status x phi in current sampled unit
+    std::vector<uint32_t> m_nPerStat;
+    std::vector<uint32_t> m_nPerEta;
+    std::vector<uint32_t> m_nPerPhi;
+
     ///! no. of events processed
     uint64_t m_nEvent {0};
 
+    ///! run no. from InitRun, used if event header is missing
+    uint64_t m_runNumber {0};
+
+    ///! whether missing event header was already reported
+    bool m_warnedNoHeader {false};
+
+    ///! no. of events seen (including those failing trigger selection)
+    uint64_t m_nSeen {0};
+
+    ///! no. of events left to skip after resuming
+    uint64_t m_nToSkip {0};
+
+    ///! no. of events seen at last checkpoint attempt
+    uint64_t m_nCheckpoint {0};
+
+    ///! whether a failing checkpoint was already reported
+    bool m_warnedCheckpoint {false};
+
+    ///! no. of records in each column file at restored checkpoint
+    std::vector<uint64_t> m_colRecords;
+
+    ///! whether first event after restored checkpoint is still to be checked
+    bool m_doVerifyResume {false};
+
+    ///! run and event no. of first event after restored checkpoint, if known
+    bool     m_hasResumeKey {false};
+    uint64_t m_resumeRun {0};
+    uint64_t m_resumeEvent {0};
+
 };  // end CaloStatusMapper
 
 #endif
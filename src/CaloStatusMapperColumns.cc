@@ -0,0 +1,578 @@
+/// ===========================================================================
+/*! \file   CaloStatusMapperColumns.cc
+ *  \author agent
+ *  \date   10.18.2026
+ *
+ *  Memory-mapped columnar files of per-event, per-channel
+ *  tower status codes produced by the CaloStatusMapper.
+ */
+/// ===========================================================================
+
+#define CLUSTERSTATUSMAPPER_COLUMNS_CC
+
+// class definitions
+#include "CaloStatusMapperColumns.h"
+
+// phool libraries
+#include <phool/phool.h>
+
+// c++ utilities
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+// posix utilities
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// abbreviate namespace for convenience
+namespace CSMC = CaloStatusMapperColumns;
+
+
+
+// writer =====================================================================
+
+// ----------------------------------------------------------------------------
+//! Writer destructor
+// ----------------------------------------------------------------------------
+CaloStatusMapperColumnWriter::~CaloStatusMapperColumnWriter()
+{
+
+  Close();
+
+}  // end dtor
+
+
+
+// ----------------------------------------------------------------------------
+//! Create a new column file and write its header
+// ----------------------------------------------------------------------------
+bool CaloStatusMapperColumnWriter::Open(
+  const std::string& file,
+  const std::string& node,
+  const uint32_t nEta,
+  const uint32_t nPhi,
+  const bool useNibbles)
+{
+
+  // make sure any previous file is closed
+  Close();
+
+  m_fd = ::open(file.data(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (m_fd < 0)
+  {
+    std::cerr << PHWHERE << ": WARNING! Couldn't open column file " << file << "!" << std::endl;
+    return false;
+  }
+
+  // set record geometry
+  SetGeometry(nEta, nPhi, useNibbles);
+
+  // map room for header plus a batch of records
+  if (!Reserve(sizeof(CSMC::Header) + (1024 * m_recordSize)))
+  {
+    std::cerr << PHWHERE << ": WARNING! Couldn't map column file " << file << "!" << std::endl;
+    ::close(m_fd);
+    m_fd = -1;
+    return false;
+  }
+
+  // fill header
+  CSMC::Header* header = GetHeader();
+  std::memcpy(header -> magic, CSMC::Magic, sizeof(CSMC::Magic));
+  header -> version        = CSMC::Version;
+  header -> bitsPerChannel = useNibbles ? 4 : 8;
+  header -> nEta           = nEta;
+  header -> nPhi           = nPhi;
+  header -> nChannels      = m_nChannels;
+  header -> recordSize     = m_recordSize;
+  header -> nEvents        = 0;
+  header -> dataOffset     = sizeof(CSMC::Header);
+  header -> indexOffset    = 0;
+  std::strncpy(header -> node, node.data(), sizeof(header -> node) - 1);
+  return true;
+
+}  // end 'Open(std::string& x 2, uint32_t x 2, bool)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Reopen an existing column file and keep its first records
+// ----------------------------------------------------------------------------
+/*! Any records (and index) past the first nRecords are dropped, and
+ *  new records are appended after them. Returns false, leaving the
+ *  file untouched, if it doesn't exist, doesn't match the given
+ *  geometry, or holds fewer than nRecords records.
+ */
+bool CaloStatusMapperColumnWriter::Resume(
+  const std::string& file,
+  const uint32_t nEta,
+  const uint32_t nPhi,
+  const bool useNibbles,
+  const uint64_t nRecords)
+{
+
+  // make sure any previous file is closed
+  Close();
+
+  m_fd = ::open(file.data(), O_RDWR);
+  if (m_fd < 0)
+  {
+    std::cerr << PHWHERE << ": WARNING! Couldn't reopen column file " << file << "!" << std::endl;
+    return false;
+  }
+
+  // check header against geometry and no. of records
+  SetGeometry(nEta, nPhi, useNibbles);
+  CSMC::Header header;
+  struct stat  info;
+  const bool isRead = (::pread(m_fd, &header, sizeof(header), 0) == (ssize_t) sizeof(header)) && (::fstat(m_fd, &info) == 0);
+  const bool isGood = isRead
+                   && (std::memcmp(header.magic, CSMC::Magic, sizeof(CSMC::Magic)) == 0)
+                   && (header.version == CSMC::Version)
+                   && (header.bitsPerChannel == (useNibbles ? 4u : 8u))
+                   && (header.nEta == nEta)
+                   && (header.nPhi == nPhi)
+                   && (header.recordSize == m_recordSize)
+                   && (header.dataOffset == sizeof(CSMC::Header))
+                   && ((header.dataOffset + (nRecords * m_recordSize)) <= static_cast<uint64_t>(info.st_size));
+  if (!isGood)
+  {
+    std::cerr << PHWHERE << ": WARNING! Column file " << file << " doesn't match checkpoint!" << std::endl;
+    ::close(m_fd);
+    m_fd = -1;
+    return false;
+  }
+
+  // drop anything past kept records, then map room for a new batch
+  const std::size_t dataEnd = header.dataOffset + (nRecords * m_recordSize);
+  if ((::ftruncate(m_fd, dataEnd) != 0) || !Reserve(dataEnd + (1024 * m_recordSize)))
+  {
+    std::cerr << PHWHERE << ": WARNING! Couldn't map column file " << file << "!" << std::endl;
+    ::close(m_fd);
+    m_fd = -1;
+    return false;
+  }
+
+  // rebuild keys of kept records
+  m_keys.resize(nRecords);
+  for (std::size_t iRecord = 0; iRecord < m_keys.size(); ++iRecord)
+  {
+    std::memcpy(&m_keys[iRecord], m_map + header.dataOffset + (iRecord * m_recordSize), sizeof(CSMC::EventKey));
+  }
+  GetHeader() -> nEvents     = nRecords;
+  GetHeader() -> indexOffset = 0;
+  return true;
+
+}  // end 'Resume(std::string&, uint32_t x 2, bool, uint64_t)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Flush records written so far to disk
+// ----------------------------------------------------------------------------
+void CaloStatusMapperColumnWriter::Flush()
+{
+
+  if (m_map)
+  {
+    ::msync(m_map, m_capacity, MS_SYNC);
+  }
+  return;
+
+}  // end 'Flush()'
+
+
+
+// ----------------------------------------------------------------------------
+//! Write index, trim file to size, and unmap
+// ----------------------------------------------------------------------------
+void CaloStatusMapperColumnWriter::Close()
+{
+
+  if (!m_map)
+  {
+    return;
+  }
+
+  // append index
+  CSMC::Header* header = GetHeader();
+  const std::size_t indexOffset = header -> dataOffset + (m_keys.size() * m_recordSize);
+  const std::size_t indexSize   = m_keys.size() * sizeof(CSMC::EventKey);
+  if (Reserve(indexOffset + indexSize))
+  {
+    header = GetHeader();
+    std::memcpy(m_map + indexOffset, m_keys.data(), indexSize);
+    header -> indexOffset = indexOffset;
+  }
+
+  // flush and trim
+  std::size_t size = indexOffset;
+  if (m_map)
+  {
+    size += (header -> indexOffset != 0) ? indexSize : 0;
+    ::msync(m_map, m_capacity, MS_SYNC);
+    ::munmap(m_map, m_capacity);
+  }
+  if (::ftruncate(m_fd, size) != 0)
+  {
+    std::cerr << PHWHERE << ": WARNING! Couldn't trim column file!" << std::endl;
+  }
+  ::close(m_fd);
+
+  m_map      = nullptr;
+  m_capacity = 0;
+  m_fd       = -1;
+  return;
+
+}  // end 'Close()'
+
+
+
+// ----------------------------------------------------------------------------
+//! Append a zeroed record for an event
+// ----------------------------------------------------------------------------
+/*! Stamps the record with its (run, event) key and returns a pointer
+ *  to its status codes, which is only valid until the next call.
+ */
+uint8_t* CaloStatusMapperColumnWriter::NextRecord(const uint64_t run, const uint64_t event)
+{
+
+  if (!m_map)
+  {
+    return nullptr;
+  }
+
+  // grow mapping geometrically if needed
+  const std::size_t offset = GetHeader() -> dataOffset + (m_keys.size() * m_recordSize);
+  if ((offset + m_recordSize) > m_capacity)
+  {
+    if (!Reserve(2 * m_capacity))
+    {
+      std::cerr << PHWHERE << ": WARNING! Couldn't grow column file!" << std::endl;
+      return nullptr;
+    }
+  }
+
+  // register event and return status codes
+  const CSMC::EventKey key = {run, event};
+  uint8_t* record = m_map + offset;
+  std::memset(record, 0, m_recordSize);
+  std::memcpy(record, &key, sizeof(CSMC::EventKey));
+  m_keys.push_back(key);
+  GetHeader() -> nEvents = m_keys.size();
+  return record + sizeof(CSMC::EventKey);
+
+}  // end 'NextRecord(uint64_t x 2)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Store status of a channel in a record
+// ----------------------------------------------------------------------------
+void CaloStatusMapperColumnWriter::SetStatus(
+  uint8_t* record,
+  const std::size_t channel,
+  const uint8_t status) const
+{
+
+  if (m_useNibbles)
+  {
+    const int shift = (channel & 1) * 4;
+    record[channel >> 1] = (record[channel >> 1] & ~(0xF << shift)) | ((status & 0xF) << shift);
+  }
+  else
+  {
+    record[channel] = status;
+  }
+  return;
+
+}  // end 'SetStatus(uint8_t*, std::size_t, uint8_t)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Set record geometry, padding records to 8 bytes
+// ----------------------------------------------------------------------------
+void CaloStatusMapperColumnWriter::SetGeometry(
+  const uint32_t nEta,
+  const uint32_t nPhi,
+  const bool useNibbles)
+{
+
+  m_useNibbles = useNibbles;
+  m_nChannels  = nEta * nPhi;
+  m_recordSize = useNibbles ? (m_nChannels + 1) / 2 : m_nChannels;
+  m_recordSize = sizeof(CSMC::EventKey) + ((m_recordSize + 7) & ~static_cast<std::size_t>(7));
+  m_keys.clear();
+  return;
+
+}  // end 'SetGeometry(uint32_t x 2, bool)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Make sure file and mapping are at least a given size
+// ----------------------------------------------------------------------------
+bool CaloStatusMapperColumnWriter::Reserve(const std::size_t size)
+{
+
+  if (size <= m_capacity)
+  {
+    return true;
+  }
+
+  // extend file
+  if (::ftruncate(m_fd, size) != 0)
+  {
+    return false;
+  }
+
+  // and remap it
+  if (m_map)
+  {
+    ::munmap(m_map, m_capacity);
+    m_map = nullptr;
+  }
+  void* map = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+  if (map == MAP_FAILED)
+  {
+    m_capacity = 0;
+    return false;
+  }
+
+  m_map      = static_cast<uint8_t*>(map);
+  m_capacity = size;
+  return true;
+
+}  // end 'Reserve(std::size_t)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Get header of mapped file
+// ----------------------------------------------------------------------------
+CSMC::Header* CaloStatusMapperColumnWriter::GetHeader() const
+{
+
+  return reinterpret_cast<CSMC::Header*>(m_map);
+
+}  // end 'GetHeader()'
+
+
+
+// reader =====================================================================
+
+// ----------------------------------------------------------------------------
+//! Reader destructor
+// ----------------------------------------------------------------------------
+CaloStatusMapperColumnReader::~CaloStatusMapperColumnReader()
+{
+
+  Close();
+
+}  // end dtor
+
+
+
+// ----------------------------------------------------------------------------
+//! Map a column file and check its header
+// ----------------------------------------------------------------------------
+bool CaloStatusMapperColumnReader::Open(const std::string& file)
+{
+
+  // make sure any previous file is closed
+  Close();
+
+  const int fd = ::open(file.data(), O_RDONLY);
+  if (fd < 0)
+  {
+    std::cerr << PHWHERE << ": WARNING! Couldn't open column file " << file << "!" << std::endl;
+    return false;
+  }
+
+  struct stat info;
+  if ((::fstat(fd, &info) != 0) || (static_cast<std::size_t>(info.st_size) < sizeof(CSMC::Header)))
+  {
+    std::cerr << PHWHERE << ": WARNING! Column file " << file << " is too small!" << std::endl;
+    ::close(fd);
+    return false;
+  }
+
+  // mapping stays valid after the descriptor is closed
+  void* map = ::mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (map == MAP_FAILED)
+  {
+    std::cerr << PHWHERE << ": WARNING! Couldn't map column file " << file << "!" << std::endl;
+    return false;
+  }
+  m_map    = static_cast<const uint8_t*>(map);
+  m_size   = info.st_size;
+  m_header = reinterpret_cast<const CSMC::Header*>(m_map);
+
+  // check format and extent of records
+  const std::size_t nCodeBytes = (m_header -> bitsPerChannel == 4) ? (m_header -> nChannels + 1) / 2 : m_header -> nChannels;
+  const bool isGood = (std::memcmp(m_header -> magic, CSMC::Magic, sizeof(CSMC::Magic)) == 0)
+                   && (m_header -> version == CSMC::Version)
+                   && ((m_header -> bitsPerChannel == 4) || (m_header -> bitsPerChannel == 8))
+                   && (m_header -> recordSize >= (sizeof(CSMC::EventKey) + nCodeBytes))
+                   && ((m_header -> dataOffset + (m_header -> nEvents * m_header -> recordSize)) <= m_size);
+  if (!isGood)
+  {
+    std::cerr << PHWHERE << ": WARNING! " << file << " is not a valid column file!" << std::endl;
+    Close();
+    return false;
+  }
+
+  // use index if present, otherwise rebuild it from the records
+  const std::size_t indexEnd = m_header -> indexOffset + (m_header -> nEvents * sizeof(CSMC::EventKey));
+  if ((m_header -> indexOffset != 0) && (indexEnd <= m_size))
+  {
+    m_keys = reinterpret_cast<const CSMC::EventKey*>(m_map + m_header -> indexOffset);
+  }
+  else
+  {
+    m_rebuilt.resize(m_header -> nEvents);
+    for (std::size_t iRecord = 0; iRecord < m_rebuilt.size(); ++iRecord)
+    {
+      std::memcpy(&m_rebuilt[iRecord], m_map + m_header -> dataOffset + (iRecord * m_header -> recordSize), sizeof(CSMC::EventKey));
+    }
+    m_keys = m_rebuilt.data();
+  }
+  m_isSorted = std::is_sorted(m_keys, m_keys + m_header -> nEvents);
+  if (!m_isSorted)
+  {
+    std::cerr << PHWHERE << ": WARNING! Records in " << file << " are out of order, lookups will use a linear search." << std::endl;
+  }
+  return true;
+
+}  // end 'Open(std::string&)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Unmap file
+// ----------------------------------------------------------------------------
+void CaloStatusMapperColumnReader::Close()
+{
+
+  if (m_map)
+  {
+    ::munmap(const_cast<uint8_t*>(m_map), m_size);
+  }
+  m_map      = nullptr;
+  m_size     = 0;
+  m_header   = nullptr;
+  m_keys     = nullptr;
+  m_isSorted = false;
+  m_rebuilt.clear();
+  return;
+
+}  // end 'Close()'
+
+
+
+// ----------------------------------------------------------------------------
+//! Get (run, event) key of a record
+// ----------------------------------------------------------------------------
+/*! Returns nullptr if the record is out of range.
+ */
+const CSMC::EventKey* CaloStatusMapperColumnReader::GetKey(const std::size_t iRecord) const
+{
+
+  if (!m_header || (iRecord >= m_header -> nEvents))
+  {
+    return nullptr;
+  }
+  return m_keys + iRecord;
+
+}  // end 'GetKey(std::size_t)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Get pointer to status codes of a record
+// ----------------------------------------------------------------------------
+/*! Records are contiguous, so the next n records of a range
+ *  follow directly at a stride of GetHeader().recordSize.
+ *  Returns nullptr if the record is out of range.
+ */
+const uint8_t* CaloStatusMapperColumnReader::GetRecord(const std::size_t iRecord) const
+{
+
+  if (!m_header || (iRecord >= m_header -> nEvents))
+  {
+    return nullptr;
+  }
+  return m_map + m_header -> dataOffset + (iRecord * m_header -> recordSize) + sizeof(CSMC::EventKey);
+
+}  // end 'GetRecord(std::size_t)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Get status of a channel in a record
+// ----------------------------------------------------------------------------
+/*! Returns CaloStatusMapperColumns::InvalidStatus if either
+ *  the record or the channel is out of range.
+ */
+uint8_t CaloStatusMapperColumnReader::GetStatus(const std::size_t iRecord, const std::size_t channel) const
+{
+
+  const uint8_t* record = GetRecord(iRecord);
+  if (!record || (channel >= m_header -> nChannels))
+  {
+    return CSMC::InvalidStatus;
+  }
+  return CSMC::GetStatus(record, channel, m_header -> bitsPerChannel);
+
+}  // end 'GetStatus(std::size_t x 2)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Find records for a range of event no.s in a run
+// ----------------------------------------------------------------------------
+/*! Returns the half-open range of record indices [begin, end) whose
+ *  keys fall in [(run, first), (run, last)]. Keys normally increase
+ *  through a file, so this is a binary search; if they don't (e.g.
+ *  runs were processed out of order) the first contiguous block of
+ *  matching records is found by a linear scan instead.
+ */
+std::pair<std::size_t, std::size_t> CaloStatusMapperColumnReader::FindRange(
+  const uint64_t run,
+  const uint64_t first,
+  const uint64_t last) const
+{
+
+  if (!m_keys || (first > last))
+  {
+    return {0, 0};
+  }
+
+  const CSMC::EventKey  lower = {run, first};
+  const CSMC::EventKey  upper = {run, last};
+  const CSMC::EventKey* end   = m_keys + m_header -> nEvents;
+  const auto isInRange = [&lower, &upper](const CSMC::EventKey& key) {
+    return !(key < lower) && !(upper < key);
+  };
+
+  // binary search if keys are ordered
+  if (m_isSorted)
+  {
+    const std::size_t begin = std::lower_bound(m_keys, end, lower) - m_keys;
+    const std::size_t stop  = std::upper_bound(m_keys, end, upper) - m_keys;
+    return {begin, std::max(begin, stop)};
+  }
+
+  // otherwise scan
+  const CSMC::EventKey* begin = std::find_if(m_keys, end, isInRange);
+  const CSMC::EventKey* stop  = std::find_if_not(begin, end, isInRange);
+  return {(std::size_t) (begin - m_keys), (std::size_t) (stop - m_keys)};
+
+}  // end 'FindRange(uint64_t x 3)'
+
+// end ========================================================================
@@ -0,0 +1,218 @@
+/// ===========================================================================
+/*! \file   CaloStatusMapperColumns.h
+ *  \author agent
+ *  \date   10.18.2026
+ *
+ *  Memory-mapped columnar files of per-event, per-channel
+ *  tower status codes produced by the CaloStatusMapper.
+ */
+/// ===========================================================================
+
+#ifndef CLUSTERSTATUSMAPPER_COLUMNS_H
+#define CLUSTERSTATUSMAPPER_COLUMNS_H
+
+// c++ utilities
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+
+// ============================================================================
+//! Layout of status column files
+// ============================================================================
+/*! A column file holds one fixed-size record per event, laid out as:
+ *
+ *      [Header][record 0][record 1]...[record N-1][index]
+ *
+ *  Each record starts with the (run, event) key of its event, followed
+ *  by its status codes (one byte or one nibble per channel). Event
+ *  no.s restart every run, so records are always identified by both.
+ *
+ *  The index repeats the key of each record contiguously. It is written
+ *  when the file is closed, so an unclosed file will have an index
+ *  offset of 0, but its index can still be rebuilt from the records.
+ */
+namespace CaloStatusMapperColumns
+{
+
+  // format identifiers
+  inline constexpr char     Magic[8] = {'C', 'S', 'M', 'C', 'O', 'L', 'S', '\0'};
+  inline constexpr uint32_t Version  = 2;
+
+  // returned for out-of-range lookups
+  inline constexpr uint8_t InvalidStatus = 0xFF;
+
+  // ==========================================================================
+  //! Run and event no. identifying a record
+  // ==========================================================================
+  struct EventKey
+  {
+    uint64_t run;    ///! run no.
+    uint64_t event;  ///! event no. within run
+
+    //! order by run, then event
+    bool operator<(const EventKey& other) const
+    {
+      return (run < other.run) || ((run == other.run) && (event < other.event));
+    }
+  };
+
+  // ==========================================================================
+  //! File header
+  // ==========================================================================
+  struct Header
+  {
+    char     magic[8];        ///! file identifier
+    uint32_t version;         ///! format version
+    uint32_t bitsPerChannel;  ///! 8 (byte) or 4 (nibble)
+    uint32_t nEta;            ///! no. of eta bins
+    uint32_t nPhi;            ///! no. of phi bins
+    uint32_t nChannels;       ///! no. of channels per record
+    uint32_t recordSize;      ///! no. of bytes per record (incl. key)
+    uint64_t nEvents;         ///! no. of records
+    uint64_t dataOffset;      ///! byte offset of 1st record
+    uint64_t indexOffset;     ///! byte offset of index (0 if absent)
+    char     node[64];        ///! name of node
+  };
+  static_assert(sizeof(Header) % 8 == 0, "Column file header must keep records 8-byte aligned");
+
+  // --------------------------------------------------------------------------
+  //! Extract status of a channel from a record's status codes
+  // --------------------------------------------------------------------------
+  inline uint8_t GetStatus(const uint8_t* record, const std::size_t channel, const uint32_t bitsPerChannel)
+  {
+    if (bitsPerChannel == 4)
+    {
+      return (record[channel >> 1] >> ((channel & 1) * 4)) & 0xF;
+    }
+    return record[channel];
+  }
+
+}  // end CaloStatusMapperColumns namespace
+
+
+
+// ============================================================================
+//! Append per-event status records to a column file
+// ============================================================================
+/*! The file is memory-mapped and grown geometrically as records
+ *  are appended, so filling a record is just a store into memory.
+ */
+class CaloStatusMapperColumnWriter
+{
+
+  public:
+
+    // ctor/dtor
+    CaloStatusMapperColumnWriter() = default;
+    ~CaloStatusMapperColumnWriter();
+
+    // not copyable
+    CaloStatusMapperColumnWriter(const CaloStatusMapperColumnWriter&) = delete;
+    CaloStatusMapperColumnWriter& operator=(const CaloStatusMapperColumnWriter&) = delete;
+
+    // file handling
+    bool Open(const std::string& file, const std::string& node, const uint32_t nEta, const uint32_t nPhi, const bool useNibbles);
+    bool Resume(const std::string& file, const uint32_t nEta, const uint32_t nPhi, const bool useNibbles, const uint64_t nRecords);
+    void Flush();
+    void Close();
+
+    // record handling
+    uint8_t* NextRecord(const uint64_t run, const uint64_t event);
+    void     SetStatus(uint8_t* record, const std::size_t channel, const uint8_t status) const;
+
+    // getters
+    bool     IsOpen() const {return m_map != nullptr;}
+    uint32_t GetNChannels() const {return m_nChannels;}
+    uint64_t GetNRecords() const {return m_keys.size();}
+
+  private:
+
+    // private methods
+    void SetGeometry(const uint32_t nEta, const uint32_t nPhi, const bool useNibbles);
+    bool Reserve(const std::size_t size);
+    CaloStatusMapperColumns::Header* GetHeader() const;
+
+    ///! file descriptor
+    int m_fd {-1};
+
+    ///! start of mapped region
+    uint8_t* m_map {nullptr};
+
+    ///! size of mapped region
+    std::size_t m_capacity {0};
+
+    ///! record geometry
+    bool        m_useNibbles {false};
+    uint32_t    m_nChannels {0};
+    std::size_t m_recordSize {0};
+
+    ///! key of each record
+    std::vector<CaloStatusMapperColumns::EventKey> m_keys;
+
+};  // end CaloStatusMapperColumnWriter
+
+
+
+// ============================================================================
+//! Zero-copy access to a column file
+// ============================================================================
+/*! The whole file is mapped read-only, and all accessors return
+ *  pointers into the mapping.
+ */
+class CaloStatusMapperColumnReader
+{
+
+  public:
+
+    // ctor/dtor
+    CaloStatusMapperColumnReader() = default;
+    ~CaloStatusMapperColumnReader();
+
+    // not copyable
+    CaloStatusMapperColumnReader(const CaloStatusMapperColumnReader&) = delete;
+    CaloStatusMapperColumnReader& operator=(const CaloStatusMapperColumnReader&) = delete;
+
+    // file handling
+    bool Open(const std::string& file);
+    void Close();
+
+    // getters
+    const CaloStatusMapperColumns::Header&   GetHeader() const {return *m_header;}
+    uint64_t                                 GetNEvents() const {return m_header->nEvents;}
+    const CaloStatusMapperColumns::EventKey* GetKeys() const {return m_keys;}
+    const CaloStatusMapperColumns::EventKey* GetKey(const std::size_t iRecord) const;
+    const uint8_t*                           GetRecord(const std::size_t iRecord) const;
+    uint8_t                                  GetStatus(const std::size_t iRecord, const std::size_t channel) const;
+
+    // find records for a range of event no.s in a run
+    std::pair<std::size_t, std::size_t> FindRange(const uint64_t run, const uint64_t first, const uint64_t last) const;
+
+  private:
+
+    ///! start of mapped region
+    const uint8_t* m_map {nullptr};
+
+    ///! size of mapped region
+    std::size_t m_size {0};
+
+    ///! header of mapped file
+    const CaloStatusMapperColumns::Header* m_header {nullptr};
+
+    ///! keys of all records, from index or rebuilt
+    const CaloStatusMapperColumns::EventKey* m_keys {nullptr};
+
+    ///! rebuilt keys if file has no index
+    std::vector<CaloStatusMapperColumns::EventKey> m_rebuilt;
+
+    ///! whether keys increase through the file
+    bool m_isSorted {false};
+
+};  // end CaloStatusMapperColumnReader
+
+#endif
+
+// end ========================================================================
@@ -19,6 +19,8 @@
 #include <TH2.h>
 
 // c++ utilities
+#include <algorithm>
+#include <cstdint>
 #include <map>
 #include <string>
 #include <utility>
@@ -39,6 +41,16 @@ namespace CaloStatusMapperDefs
   // convenience types
   typedef std::pair<std::string, int> NodeDef;
 
+  // checkpoint format identifiers
+  inline constexpr char     CheckpointMagic[8] = {'C', 'S', 'M', 'C', 'K', 'P', 'T', '\0'};
+  inline constexpr uint32_t CheckpointVersion  = 3;
+
+  // no. of column records checkpointed for a node whose export was turned off
+  inline constexpr uint64_t CheckpointNoExport = UINT64_MAX;
+
+  // no. of histogram statistics to checkpoint (cf. TH1::kNstat)
+  inline constexpr std::size_t NStats = 13;
+
 
 
   // ==========================================================================
@@ -74,6 +86,20 @@ namespace CaloStatusMapperDefs
 
 
 
+  // ==========================================================================
+  //! Sampling modes
+  // ==========================================================================
+  /*! This enumerates what units are sampled when
+   *  sampling is turned on.
+   */
+  enum Sample
+  {
+    Events,  ///!< process a fraction of events
+    Blocks   ///!< process a fraction of tower blocks in every event
+  };
+
+
+
   // ==========================================================================
   //! Maps status codes onto labels
   // ==========================================================================
@@ -126,6 +152,7 @@ namespace CaloStatusMapperDefs
     AxisDef stat {"Status", S, -0.5, S - 0.5};
     AxisDef eta  {"i_{#eta}", H, -0.5, H - 0.5};
     AxisDef phi  {"i_{#phi}", F, -0.5, F - 0.5};
+    AxisDef frac {"Fraction of towers", 101, 0., 1.01};
 
     //! make 1 1d status plot
     TH1D* MakeStatus1D(const std::string& name) const
@@ -148,6 +175,13 @@ namespace CaloStatusMapperDefs
       return new TH1D(name.data(), title.data(), phi.nBins, phi.start, phi.stop);
     }
 
+    //! make a 1d fraction plot
+    TH1D* MakeFrac1D(const std::string& name) const
+    {
+      const std::string title = ";" + frac.label;
+      return new TH1D(name.data(), title.data(), frac.nBins, frac.start, frac.stop);
+    }
+
     //! make a 2d eta-phi plot
     TH2D* MakePhiEta2D(const std::string& name) const
     {
@@ -165,6 +199,71 @@ namespace CaloStatusMapperDefs
 
 
 
+  // ==========================================================================
+  //! Packed per-channel bitset
+  // ==========================================================================
+  /*! A lightweight bitset with one bit per tower channel, packed into
+   *  64-bit words so that two sets can be compared a word at a time.
+   */
+  struct StatusBits
+  {
+
+    // members
+    std::vector<uint64_t> words;  ///! packed bits, channel i in word i / 64
+
+    //! size to hold a given no. of channels, clearing all bits
+    void Resize(const std::size_t nChannels)
+    {
+      words.assign((nChannels + 63) / 64, 0);
+    }
+
+    //! clear all bits
+    void Clear()
+    {
+      std::fill(words.begin(), words.end(), 0);
+    }
+
+    //! set bit for a channel
+    void Set(const std::size_t channel)
+    {
+      words[channel >> 6] |= (uint64_t(1) << (channel & 63));
+    }
+
+    //! check bit for a channel
+    bool Test(const std::size_t channel) const
+    {
+      return (words[channel >> 6] >> (channel & 63)) & 1;
+    }
+
+  };  // end StatusBits
+
+  // -------------------------------------------------------------------------
+  //! One bitset per (known) status code
+  // -------------------------------------------------------------------------
+  typedef std::vector<StatusBits> StatusPlanes;
+
+
+
+  // ==========================================================================
+  //! Decide if a sampling unit should be processed
+  // ==========================================================================
+  /*! Hashes the unit's id (splitmix64) onto [0, 1) and compares it
+   *  to the fraction, so the decision is deterministic for a given
+   *  id but uncorrelated between neighboring ids.
+   */
+  inline bool IsSampled(const uint64_t id, const double fraction)
+  {
+
+    uint64_t hash = id + 0x9E3779B97F4A7C15ULL;
+    hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBULL;
+    hash = hash ^ (hash >> 31);
+    return ((hash >> 11) * 0x1.0p-53) < fraction;
+
+  }  // end 'IsSampled(uint64_t, double)'
+
+
+
   // ==========================================================================
   //! Returns enum corresponding to given tower status
   // ==========================================================================
@@ -0,0 +1,332 @@
+/// ===========================================================================
+/*! \file   CaloStatusMapperShm.cc
+ *  \author agent
+ *  \date   10.18.2026
+ *
+ *  Live export of CaloStatusMapper status maps through
+ *  a POSIX shared-memory segment.
+ */
+/// ===========================================================================
+
+#define CLUSTERSTATUSMAPPER_SHM_CC
+
+// class definitions
+#include "CaloStatusMapperShm.h"
+
+// phool libraries
+#include <phool/phool.h>
+
+// c++ utilities
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+// posix utilities
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// abbreviate namespace for convenience
+namespace CSMS = CaloStatusMapperShm;
+
+
+
+// publisher ==================================================================
+
+// ----------------------------------------------------------------------------
+//! Publisher destructor
+// ----------------------------------------------------------------------------
+CaloStatusMapperShmPublisher::~CaloStatusMapperShmPublisher()
+{
+
+  Close();
+
+}  // end dtor
+
+
+
+// ----------------------------------------------------------------------------
+//! Create segment and describe nodes
+// ----------------------------------------------------------------------------
+/*! The segment is created exclusively, so a job never takes over
+ *  (and later removes) a segment another job is still publishing
+ *  to. Returns false if a segment with this name already exists.
+ */
+bool CaloStatusMapperShmPublisher::Open(
+  const std::string& name,
+  std::vector<CSMS::NodeInfo> nodes,
+  const std::vector<std::string>& labels)
+{
+
+  // make sure any previous segment is closed
+  Close();
+
+  if (nodes.size() > CSMS::MaxNodes)
+  {
+    std::cerr << PHWHERE << ": WARNING! Only the first " << CSMS::MaxNodes << " nodes will be published!" << std::endl;
+    nodes.resize(CSMS::MaxNodes);
+  }
+
+  // lay out buffers
+  std::size_t bufferSize = 0;
+  for (auto& node : nodes)
+  {
+    node.offset = bufferSize;
+    bufferSize += (std::size_t) node.nStat * node.nPhi * node.nEta;
+  }
+  const std::size_t headerSize = (sizeof(CSMS::Header) + 63) & ~static_cast<std::size_t>(63);
+  const std::size_t size       = headerSize + (2 * bufferSize * sizeof(double));
+
+  // create and map segment
+  const int fd = ::shm_open(name.data(), O_RDWR | O_CREAT | O_EXCL, 0644);
+  if ((fd < 0) && (errno == EEXIST))
+  {
+    std::cerr << PHWHERE << ": WARNING! Shared-memory segment " << name << " already exists! It may belong to another job\n"
+              << "  (or to a crashed one, in which case remove /dev/shm" << name << "). Maps won't be published."
+              << std::endl;
+    return false;
+  }
+  if (fd < 0)
+  {
+    std::cerr << PHWHERE << ": WARNING! Couldn't create shared-memory segment " << name << "!" << std::endl;
+    return false;
+  }
+  void* map = MAP_FAILED;
+  if (::ftruncate(fd, size) == 0)
+  {
+    map = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  ::close(fd);
+  if (map == MAP_FAILED)
+  {
+    std::cerr << PHWHERE << ": WARNING! Couldn't map shared-memory segment " << name << "!" << std::endl;
+    ::shm_unlink(name.data());
+    return false;
+  }
+  m_name = name;
+  m_size = size;
+
+  // fill header
+  m_header = new (map) CSMS::Header();
+  std::memcpy(m_header -> magic, CSMS::Magic, sizeof(CSMS::Magic));
+  m_header -> version         = CSMS::Version;
+  m_header -> nNodes          = nodes.size();
+  m_header -> bufferSize      = bufferSize;
+  m_header -> bufferOffset[0] = headerSize;
+  m_header -> bufferOffset[1] = headerSize + (bufferSize * sizeof(double));
+  m_header -> nEvent[0]       = 0;
+  m_header -> nEvent[1]       = 0;
+  std::copy(nodes.begin(), nodes.end(), m_header -> nodes);
+  for (std::size_t iStat = 0; iStat < std::min(labels.size(), CSMS::MaxStats); ++iStat)
+  {
+    std::strncpy(m_header -> labels[iStat], labels[iStat].data(), sizeof(m_header -> labels[iStat]) - 1);
+  }
+  m_header -> active.store(0, std::memory_order_relaxed);
+  m_header -> finished.store(0, std::memory_order_relaxed);
+  m_header -> sequence.store(0, std::memory_order_release);
+  return true;
+
+}  // end 'Open(std::string&, std::vector<NodeInfo>, std::vector<std::string>&)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Mark segment as finished, then unmap and remove it
+// ----------------------------------------------------------------------------
+void CaloStatusMapperShmPublisher::Close()
+{
+
+  if (!m_header)
+  {
+    return;
+  }
+
+  m_header -> finished.store(1, std::memory_order_release);
+  ::munmap(m_header, m_size);
+  ::shm_unlink(m_name.data());
+  m_header = nullptr;
+  m_size   = 0;
+  return;
+
+}  // end 'Close()'
+
+
+
+// ----------------------------------------------------------------------------
+//! Get buffer to write next update into
+// ----------------------------------------------------------------------------
+/*! This is always the inactive buffer, so readers are never
+ *  disturbed while it's being filled. A reader may still be copying
+ *  it from before the last flip, though, so the fence keeps the
+ *  stores into it from becoming visible ahead of the sequence
+ *  increments of that flip; the reader then sees the counter change
+ *  and retries.
+ */
+double* CaloStatusMapperShmPublisher::BeginUpdate()
+{
+
+  if (!m_header)
+  {
+    return nullptr;
+  }
+
+  const uint64_t back = 1 - m_header -> active.load(std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  return reinterpret_cast<double*>(reinterpret_cast<char*>(m_header) + m_header -> bufferOffset[back]);
+
+}  // end 'BeginUpdate()'
+
+
+
+// ----------------------------------------------------------------------------
+//! Make the freshly written buffer active
+// ----------------------------------------------------------------------------
+void CaloStatusMapperShmPublisher::EndUpdate(const uint64_t nEvent)
+{
+
+  if (!m_header)
+  {
+    return;
+  }
+
+  const uint64_t back = 1 - m_header -> active.load(std::memory_order_relaxed);
+  m_header -> nEvent[back] = nEvent;
+
+  // flip buffers inside an odd sequence
+  m_header -> sequence.fetch_add(1, std::memory_order_acq_rel);
+  m_header -> active.store(back, std::memory_order_release);
+  m_header -> sequence.fetch_add(1, std::memory_order_release);
+  return;
+
+}  // end 'EndUpdate(uint64_t)'
+
+
+
+// reader =====================================================================
+
+// ----------------------------------------------------------------------------
+//! Reader destructor
+// ----------------------------------------------------------------------------
+CaloStatusMapperShmReader::~CaloStatusMapperShmReader()
+{
+
+  Detach();
+
+}  // end dtor
+
+
+
+// ----------------------------------------------------------------------------
+//! Map an existing segment read-only
+// ----------------------------------------------------------------------------
+bool CaloStatusMapperShmReader::Attach(const std::string& name)
+{
+
+  // make sure any previous segment is detached
+  Detach();
+
+  const int fd = ::shm_open(name.data(), O_RDONLY, 0);
+  if (fd < 0)
+  {
+    std::cerr << PHWHERE << ": WARNING! Couldn't open shared-memory segment " << name << "!" << std::endl;
+    return false;
+  }
+
+  struct stat info;
+  void* map = MAP_FAILED;
+  if ((::fstat(fd, &info) == 0) && (static_cast<std::size_t>(info.st_size) >= sizeof(CSMS::Header)))
+  {
+    map = ::mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  }
+  ::close(fd);
+  if (map == MAP_FAILED)
+  {
+    std::cerr << PHWHERE << ": WARNING! Couldn't map shared-memory segment " << name << "!" << std::endl;
+    return false;
+  }
+  m_header = static_cast<const CSMS::Header*>(map);
+  m_size   = info.st_size;
+
+  // check format
+  const bool isGood = (std::memcmp(m_header -> magic, CSMS::Magic, sizeof(CSMS::Magic)) == 0)
+                   && (m_header -> version == CSMS::Version)
+                   && ((m_header -> bufferOffset[1] + (m_header -> bufferSize * sizeof(double))) <= m_size);
+  if (!isGood)
+  {
+    std::cerr << PHWHERE << ": WARNING! " << name << " is not a valid status map segment!" << std::endl;
+    Detach();
+    return false;
+  }
+  return true;
+
+}  // end 'Attach(std::string&)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Unmap segment
+// ----------------------------------------------------------------------------
+void CaloStatusMapperShmReader::Detach()
+{
+
+  if (m_header)
+  {
+    ::munmap(const_cast<CSMS::Header*>(m_header), m_size);
+  }
+  m_header = nullptr;
+  m_size   = 0;
+  return;
+
+}  // end 'Detach()'
+
+
+
+// ----------------------------------------------------------------------------
+//! Copy out the active buffer
+// ----------------------------------------------------------------------------
+/*! Retries until the sequence counter shows no flip happened during
+ *  the copy, so the publisher never has to wait on a reader.
+ */
+bool CaloStatusMapperShmReader::Snapshot(
+  std::vector<double>& counts,
+  uint64_t& nEvent,
+  const std::size_t maxTries) const
+{
+
+  if (!m_header)
+  {
+    return false;
+  }
+
+  counts.resize(m_header -> bufferSize);
+  for (std::size_t iTry = 0; iTry < maxTries; ++iTry)
+  {
+
+    // skip if a flip is in progress
+    const uint64_t before = m_header -> sequence.load(std::memory_order_acquire);
+    if (before & 1)
+    {
+      continue;
+    }
+
+    // copy active buffer
+    const uint64_t active = m_header -> active.load(std::memory_order_acquire);
+    const double*  buffer = reinterpret_cast<const double*>(reinterpret_cast<const char*>(m_header) + m_header -> bufferOffset[active]);
+    std::memcpy(counts.data(), buffer, counts.size() * sizeof(double));
+    nEvent = m_header -> nEvent[active];
+
+    // and check nothing changed
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (m_header -> sequence.load(std::memory_order_relaxed) == before)
+    {
+      return true;
+    }
+  }
+  return false;
+
+}  // end 'Snapshot(std::vector<double>&, uint64_t&, std::size_t)'
+
+// end ========================================================================
@@ -0,0 +1,168 @@
+/// ===========================================================================
+/*! \file   CaloStatusMapperShm.h
+ *  \author agent
+ *  \date   10.18.2026
+ *
+ *  Live export of CaloStatusMapper status maps through
+ *  a POSIX shared-memory segment.
+ */
+/// ===========================================================================
+
+#ifndef CLUSTERSTATUSMAPPER_SHM_H
+#define CLUSTERSTATUSMAPPER_SHM_H
+
+// c++ utilities
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+
+// ============================================================================
+//! Layout of shared-memory segment
+// ============================================================================
+/*! The segment holds a header followed by two buffers of counts. Each
+ *  buffer holds, for every node, nStat x nPhi x nEta doubles with the
+ *  count of channel (eta, phi) having a given status at index
+ *
+ *      offset + (((iStat * nPhi) + iPhi) * nEta) + iEta
+ *
+ *  The publisher only ever writes the inactive buffer, then flips
+ *  which buffer is active. The flip is bracketed by increments of a
+ *  sequence counter, so a reader knows its copy of the active buffer
+ *  is consistent if the counter is even and unchanged across the copy.
+ *
+ *  When the publisher closes, it raises the finished flag and removes
+ *  the segment's name. Readers still attached keep their mapping, and
+ *  so can still read the final maps.
+ */
+namespace CaloStatusMapperShm
+{
+
+  // format identifiers and limits
+  inline constexpr char        Magic[8] = {'C', 'S', 'M', 'S', 'H', 'M', '\0', '\0'};
+  inline constexpr uint32_t    Version  = 2;
+  inline constexpr std::size_t MaxNodes = 16;
+  inline constexpr std::size_t MaxStats = 8;
+
+  // ==========================================================================
+  //! Description of a node's maps
+  // ==========================================================================
+  struct NodeInfo
+  {
+    char     name[64];  ///! name of node
+    uint32_t nEta;      ///! no. of eta bins
+    uint32_t nPhi;      ///! no. of phi bins
+    uint32_t nStat;     ///! no. of status codes
+    uint32_t pad;       ///! (unused)
+    uint64_t offset;    ///! offset of node's counts in a buffer
+  };
+
+  // ==========================================================================
+  //! Segment header
+  // ==========================================================================
+  struct Header
+  {
+    char                  magic[8];              ///! segment identifier
+    uint32_t              version;               ///! format version
+    uint32_t              nNodes;                ///! no. of nodes
+    std::atomic<uint64_t> sequence;              ///! odd while buffers are flipping
+    std::atomic<uint64_t> active;                ///! index of buffer to read
+    std::atomic<uint64_t> finished;              ///! nonzero once publisher has closed
+    uint64_t              nEvent[2];             ///! no. of events in each buffer
+    uint64_t              bufferSize;            ///! no. of doubles per buffer
+    uint64_t              bufferOffset[2];       ///! byte offset of each buffer
+    char                  labels[MaxStats][16];  ///! status labels
+    NodeInfo              nodes[MaxNodes];       ///! node descriptions
+  };
+  static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared-memory sequence counter must be lock-free");
+
+}  // end CaloStatusMapperShm namespace
+
+
+
+// ============================================================================
+//! Publish status maps to a shared-memory segment
+// ============================================================================
+class CaloStatusMapperShmPublisher
+{
+
+  public:
+
+    // ctor/dtor
+    CaloStatusMapperShmPublisher() = default;
+    ~CaloStatusMapperShmPublisher();
+
+    // not copyable
+    CaloStatusMapperShmPublisher(const CaloStatusMapperShmPublisher&) = delete;
+    CaloStatusMapperShmPublisher& operator=(const CaloStatusMapperShmPublisher&) = delete;
+
+    // segment handling
+    bool Open(const std::string& name, std::vector<CaloStatusMapperShm::NodeInfo> nodes, const std::vector<std::string>& labels);
+    void Close();
+
+    // update handling
+    double* BeginUpdate();
+    void    EndUpdate(const uint64_t nEvent);
+
+    // getters
+    bool IsOpen() const {return m_header != nullptr;}
+    const CaloStatusMapperShm::NodeInfo& GetNode(const std::size_t iNode) const {return m_header->nodes[iNode];}
+
+  private:
+
+    ///! name of segment
+    std::string m_name;
+
+    ///! mapped segment
+    CaloStatusMapperShm::Header* m_header {nullptr};
+
+    ///! size of mapped segment
+    std::size_t m_size {0};
+
+};  // end CaloStatusMapperShmPublisher
+
+
+
+// ============================================================================
+//! Read status maps from a shared-memory segment
+// ============================================================================
+class CaloStatusMapperShmReader
+{
+
+  public:
+
+    // ctor/dtor
+    CaloStatusMapperShmReader() = default;
+    ~CaloStatusMapperShmReader();
+
+    // not copyable
+    CaloStatusMapperShmReader(const CaloStatusMapperShmReader&) = delete;
+    CaloStatusMapperShmReader& operator=(const CaloStatusMapperShmReader&) = delete;
+
+    // segment handling
+    bool Attach(const std::string& name);
+    void Detach();
+
+    // copy out a consistent set of counts
+    bool Snapshot(std::vector<double>& counts, uint64_t& nEvent, const std::size_t maxTries = 1000) const;
+
+    // getters
+    const CaloStatusMapperShm::Header& GetHeader() const {return *m_header;}
+    bool IsFinished() const {return m_header -> finished.load(std::memory_order_acquire) != 0;}
+
+  private:
+
+    ///! mapped segment
+    const CaloStatusMapperShm::Header* m_header {nullptr};
+
+    ///! size of mapped segment
+    std::size_t m_size {0};
+
+};  // end CaloStatusMapperShmReader
+
+#endif
+
+// end ========================================================================
@@ -0,0 +1,251 @@
+/// ===========================================================================
+/*! \file   CaloStatusMapperShmDump.cc
+ *  \author agent
+ *  \date   10.18.2026
+ *
+ *  A small tool to attach to a running CaloStatusMapper's
+ *  shared-memory segment and render or dump its status maps.
+ *
+ *  Usage:
+ *      calostatusmapper-shmdump [options] <segment> [node] [status]
+ *
+ *  Options:
+ *      -r      dump raw "<iEta> <iPhi> <count>" lines instead of rendering
+ *      -w <n>  redraw every <n> seconds until interrupted or the
+ *              publisher finishes
+ */
+/// ===========================================================================
+
+#define CLUSTERSTATUSMAPPER_SHMDUMP_CC
+
+// class definitions
+#include "CaloStatusMapperShm.h"
+
+// c++ utilities
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+// posix utilities
+#include <unistd.h>
+
+// abbreviate namespace for convenience
+namespace CSMS = CaloStatusMapperShm;
+
+
+
+// helper methods =============================================================
+
+// ----------------------------------------------------------------------------
+//! Find index of a node or status by name or number
+// ----------------------------------------------------------------------------
+int FindIndex(const std::string& arg, const std::vector<std::string>& names)
+{
+
+  const auto name = std::find(names.begin(), names.end(), arg);
+  if (name != names.end())
+  {
+    return name - names.begin();
+  }
+
+  char* end = nullptr;
+  const long index = std::strtol(arg.data(), &end, 10);
+  if ((*end != '\0') || (index < 0) || (index >= (long) names.size()))
+  {
+    return -1;
+  }
+  return index;
+
+}  // end 'FindIndex(std::string&, std::vector<std::string>&)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Print per-node, per-status totals
+// ----------------------------------------------------------------------------
+void PrintSummary(const CSMS::Header& header, const std::vector<double>& counts, const uint64_t nEvent)
+{
+
+  std::cout << "No. of events = " << nEvent << "\n";
+  for (uint32_t iNode = 0; iNode < header.nNodes; ++iNode)
+  {
+    const CSMS::NodeInfo& node  = header.nodes[iNode];
+    const std::size_t     nCell = (std::size_t) node.nEta * node.nPhi;
+    std::cout << "  [" << iNode << "] " << node.name << "\n";
+    for (uint32_t iStat = 0; iStat < node.nStat; ++iStat)
+    {
+      const auto   begin = counts.begin() + node.offset + (iStat * nCell);
+      const double total = std::accumulate(begin, begin + nCell, 0.);
+      std::cout << "      " << header.labels[iStat] << " = " << total;
+      if (nEvent > 0)
+      {
+        std::cout << " (" << total / (double) nEvent << " per event)";
+      }
+      std::cout << "\n";
+    }
+  }
+  std::cout << std::flush;
+
+}  // end 'PrintSummary(CSMS::Header&, std::vector<double>&, uint64_t)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Render or dump the map of a node and status
+// ----------------------------------------------------------------------------
+/*! Rendering draws phi as rows and eta as columns, merging
+ *  neighboring bins so the map fits in a terminal.
+ */
+void PrintMap(
+  const CSMS::NodeInfo& node,
+  const std::vector<double>& counts,
+  const uint32_t iStat,
+  const bool doRaw)
+{
+
+  const double* map = counts.data() + node.offset + ((std::size_t) iStat * node.nEta * node.nPhi);
+
+  // dump raw counts if needed
+  if (doRaw)
+  {
+    for (uint32_t iPhi = 0; iPhi < node.nPhi; ++iPhi)
+    {
+      for (uint32_t iEta = 0; iEta < node.nEta; ++iEta)
+      {
+        std::cout << iEta << " " << iPhi << " " << map[(iPhi * node.nEta) + iEta] << "\n";
+      }
+    }
+    std::cout << std::flush;
+    return;
+  }
+
+  // otherwise merge bins and render
+  const std::string shades = " .:-=+*#%@";
+  const uint32_t    etaStep = std::max<uint32_t>(1, (node.nEta + 95) / 96);
+  const uint32_t    phiStep = std::max<uint32_t>(1, (node.nPhi + 47) / 48);
+  const uint32_t    nCols   = (node.nEta + etaStep - 1) / etaStep;
+  const uint32_t    nRows   = (node.nPhi + phiStep - 1) / phiStep;
+
+  std::vector<double> merged(nCols * nRows, 0.);
+  for (uint32_t iPhi = 0; iPhi < node.nPhi; ++iPhi)
+  {
+    for (uint32_t iEta = 0; iEta < node.nEta; ++iEta)
+    {
+      merged[((iPhi / phiStep) * nCols) + (iEta / etaStep)] += map[(iPhi * node.nEta) + iEta];
+    }
+  }
+  const double maximum = *std::max_element(merged.begin(), merged.end());
+
+  for (uint32_t iRow = nRows; iRow > 0; --iRow)
+  {
+    std::string line;
+    for (uint32_t iCol = 0; iCol < nCols; ++iCol)
+    {
+      const double value = merged[((iRow - 1) * nCols) + iCol];
+      const std::size_t iShade = (maximum > 0.) ? (std::size_t) ((shades.size() - 1) * (value / maximum)) : 0;
+      line += shades[iShade];
+    }
+    std::cout << "|" << line << "|\n";
+  }
+  std::cout << "max. per cell = " << maximum << " (" << etaStep << " eta x " << phiStep << " phi bins per cell)" << std::endl;
+
+}  // end 'PrintMap(CSMS::NodeInfo&, std::vector<double>&, uint32_t, bool)'
+
+
+
+// main =======================================================================
+
+int main(int argc, char* argv[])
+{
+
+  // parse options
+  bool doRaw = false;
+  int  wait  = 0;
+  int  opt   = 0;
+  while ((opt = ::getopt(argc, argv, "rw:")) != -1)
+  {
+    switch (opt)
+    {
+      case 'r':
+        doRaw = true;
+        break;
+      case 'w':
+        wait = std::atoi(optarg);
+        break;
+      default:
+        std::cerr << "Usage: " << argv[0] << " [-r] [-w <seconds>] <segment> [node] [status]" << std::endl;
+        return 1;
+    }
+  }
+  if (optind >= argc)
+  {
+    std::cerr << "Usage: " << argv[0] << " [-r] [-w <seconds>] <segment> [node] [status]" << std::endl;
+    return 1;
+  }
+
+  // attach to segment
+  CaloStatusMapperShmReader reader;
+  if (!reader.Attach(argv[optind]))
+  {
+    return 1;
+  }
+  const CSMS::Header& header = reader.GetHeader();
+
+  // collect node and status names
+  std::vector<std::string> nodes;
+  std::vector<std::string> stats;
+  for (uint32_t iNode = 0; iNode < header.nNodes; ++iNode)
+  {
+    nodes.push_back(header.nodes[iNode].name);
+  }
+  for (std::size_t iStat = 0; iStat < CSMS::MaxStats; ++iStat)
+  {
+    stats.push_back(header.labels[iStat]);
+  }
+
+  // pick out map to show, if any
+  const int iNode = ((optind + 1) < argc) ? FindIndex(argv[optind + 1], nodes) : -1;
+  const int iStat = ((optind + 2) < argc) ? FindIndex(argv[optind + 2], stats) : 0;
+  if ((((optind + 1) < argc) && (iNode < 0)) || (iStat < 0) || ((iNode >= 0) && ((uint32_t) iStat >= header.nodes[iNode].nStat)))
+  {
+    std::cerr << "Unknown node or status!" << std::endl;
+    return 1;
+  }
+
+  // show current maps
+  std::vector<double> counts;
+  uint64_t nEvent = 0;
+  do
+  {
+    if (!reader.Snapshot(counts, nEvent))
+    {
+      std::cerr << "Couldn't get a consistent snapshot, retrying..." << std::endl;
+    }
+    else if (iNode < 0)
+    {
+      PrintSummary(header, counts, nEvent);
+    }
+    else
+    {
+      std::cout << nodes[iNode] << ", " << stats[iStat] << ", no. of events = " << nEvent << "\n";
+      PrintMap(header.nodes[iNode], counts, iStat, doRaw);
+    }
+    if (reader.IsFinished())
+    {
+      std::cerr << "Publisher has finished, these are its final maps." << std::endl;
+      break;
+    }
+    if (wait > 0)
+    {
+      ::sleep(wait);
+    }
+  } while (wait > 0);
+  return 0;
+
+}
+
+// end ========================================================================